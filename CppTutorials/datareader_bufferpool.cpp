@@ -0,0 +1,373 @@
+/*************************************************************************************
+ Copyright (C) 2021 Over-Infinity.
+ Everyone is permitted to copy and distribute verbatim copies of this license document
+ This Sampel shows how to read a stream through a pooled, zero-copy buffer interface
+ (c++20, build: g++ -std=c++20 -O2 -pthread datareader_bufferpool.cpp)
+**************************************************************************************/
+#include <iostream>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <span>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+/* In datareader.cpp the stream appends one char at a time with push_back, so the vector
+ * reallocates again and again and DataReader::content grows without bound.
+ * Here the stream writes into fixed-size slabs taken from a BufferPool and the reader
+ * only receives a std::span<const char> view of each slab. No copy is made on the reader
+ * side and once the pool is warm no allocation is made at all:
+ *  - every slab is reference counted, the last SlabRef that goes away gives it back.
+ *  - released slabs go to a small per-thread cache first, so acquire/release on the
+ *    same thread does not touch the shared mutex. The caches of a pool are registered
+ *    with it: a producer that finds the pool empty at the cap takes the cached slabs back
+ *    before it sleeps, a thread that exits gives its cache back.
+ *  - the pool never holds more than max_bytes of slabs. When the cap is reached acquire()
+ *    blocks until a reader releases a slab, which is the backpressure for the producer. */
+class BufferPool{
+
+    struct Slab{
+        std::atomic<int> refs;
+        BufferPool* owner;
+        size_t used;
+        Slab* next;
+        char* data(){ return reinterpret_cast<char*>(this + 1); }
+    };
+
+public:
+    /* SlabRef: reference counted handle of one slab. copy adds a reference, move does not. */
+    class SlabRef{
+    public:
+        SlabRef():slab(nullptr){}
+        SlabRef(const SlabRef& other):slab(other.slab){
+            if(slab) slab->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        SlabRef(SlabRef&& other) noexcept :slab(other.slab){ other.slab = nullptr; }
+        SlabRef& operator=(SlabRef other) noexcept { std::swap(slab, other.slab); return *this; }
+        ~SlabRef(){ reset(); }
+
+        void reset(){
+            if(slab && slab->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                slab->owner->release(slab);
+            slab = nullptr;
+        }
+        /* writable area, only meant for the producer that filled the slab */
+        std::span<char> buffer() const { return {slab->data(), slab->owner->slab_size}; }
+        void commit(size_t n) const {
+            if(n > slab->owner->slab_size) throw std::length_error("SlabRef::commit: more bytes than the slab holds");
+            slab->used = n;
+        }
+        /* read only view of the committed bytes */
+        std::span<const char> view() const { return {slab->data(), slab->used}; }
+        explicit operator bool() const { return slab != nullptr; }
+
+    private:
+        friend class BufferPool;
+        explicit SlabRef(Slab* s):slab(s){}
+        Slab* slab;
+    };
+
+    BufferPool(size_t _slab_size, size_t _max_bytes):slab_size(_slab_size),
+    max_slabs(_max_bytes / (_slab_size + sizeof(Slab)) ? _max_bytes / (_slab_size + sizeof(Slab)) : 1),
+    cache_limit(std::min<size_t>(LOCAL_CACHE_LIMIT, max_slabs / (2 * std::max(1u, std::thread::hardware_concurrency())))),
+    free_list(nullptr),created(0),waiters(0){
+    }
+
+    ~BufferPool(){
+        /* all SlabRef objects must be released, and no other thread may use the pool, before it goes away */
+        std::lock_guard<std::mutex> lock(mutex);
+        for(LocalCache* cache : caches){
+            std::lock_guard<std::mutex> cache_lock(cache->mutex);
+            take_cache(*cache);
+            cache->pool = nullptr;
+        }
+        while(free_list){
+            Slab* s = free_list;
+            free_list = s->next;
+            std::free(s);
+        }
+    }
+
+    SlabRef acquire(){
+        LocalCache& cache = local_cache();
+        if(cache.pool != this) cache.attach(this);
+        {
+            std::lock_guard<std::mutex> cache_lock(cache.mutex);
+            if(cache.head){
+                Slab* s = cache.head;
+                cache.head = s->next;
+                cache.count--;
+                return prepare(s);
+            }
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        for(;;){
+            if(free_list){
+                Slab* s = free_list;
+                free_list = s->next;
+                return prepare(s);
+            }
+            if(created < max_slabs){
+                created++;
+                lock.unlock();
+                void* mem = std::malloc(sizeof(Slab) + slab_size);
+                if(!mem){
+                    lock.lock();
+                    created--;
+                    throw std::bad_alloc();
+                }
+                Slab* s = new (mem) Slab;
+                s->owner = this;
+                return prepare(s);
+            }
+            /* memory cap reached: take back what the other threads keep in their caches,
+             * or wait for a reader to give back a slab. waiters is raised first, a release()
+             * that still puts a slab into its cache after that sees it and hands the slab
+             * over (see release()) */
+            waiters++;
+            for(LocalCache* other : caches){
+                std::lock_guard<std::mutex> cache_lock(other->mutex);
+                take_cache(*other);
+            }
+            if(!free_list) available.wait(lock);
+            waiters--;
+        }
+    }
+
+    size_t slabs_created() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return created;
+    }
+    const size_t slab_size;
+
+private:
+    static constexpr size_t LOCAL_CACHE_LIMIT = 8;
+
+    /* per-thread free list of the last pool used on this thread. Its mutex is only ever
+     * contended by a blocked acquire() of another thread that takes the slabs back */
+    struct LocalCache{
+        std::mutex mutex;
+        BufferPool* pool = nullptr;
+        Slab* head = nullptr;
+        size_t count = 0;
+
+        /* registers with pool, after giving the slabs of the previous pool back to it */
+        void attach(BufferPool* next){
+            detach();
+            std::lock_guard<std::mutex> lock(next->mutex);
+            std::lock_guard<std::mutex> cache_lock(mutex);
+            pool = next;
+            next->caches.push_back(this);
+        }
+        void detach(){
+            BufferPool* p;
+            {
+                std::lock_guard<std::mutex> cache_lock(mutex);
+                p = pool;
+            }
+            if(!p) return;
+            {
+                std::lock_guard<std::mutex> lock(p->mutex);
+                std::lock_guard<std::mutex> cache_lock(mutex);
+                p->take_cache(*this);
+                p->caches.erase(std::find(p->caches.begin(), p->caches.end(), this));
+                pool = nullptr;
+            }
+            p->available.notify_all();
+        }
+        ~LocalCache(){ detach(); }
+    };
+    static LocalCache& local_cache(){
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    /* moves the slabs of cache to the shared list, both mutexes held */
+    void take_cache(LocalCache& cache){
+        while(cache.head){
+            Slab* s = cache.head;
+            cache.head = s->next;
+            s->next = free_list;
+            free_list = s;
+        }
+        cache.count = 0;
+    }
+
+    static SlabRef prepare(Slab* s){
+        s->refs.store(1, std::memory_order_relaxed);
+        s->used = 0;
+        s->next = nullptr;
+        return SlabRef(s);
+    }
+
+    void release(Slab* s){
+        LocalCache& cache = local_cache();
+        /* only a thread that acquires from this pool keeps slabs for itself, and only while
+         * nobody waits. waiters is read after the slab is in the cache: an acquire() that
+         * raised it earlier gets the slab here, one that raises it later finds it in the cache */
+        if(cache.pool == this && cache_limit){
+            std::lock_guard<std::mutex> cache_lock(cache.mutex);
+            if(cache.pool == this && cache.count < cache_limit){
+                s->next = cache.head;
+                cache.head = s;
+                cache.count++;
+                if(waiters.load() == 0) return;
+                cache.head = s->next;
+                cache.count--;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s->next = free_list;
+            free_list = s;
+        }
+        available.notify_one();
+    }
+
+    const size_t max_slabs;
+    const size_t cache_limit;          /* slabs per thread cache, a share of max_slabs */
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    Slab* free_list;
+    size_t created;
+    std::atomic<int> waiters;
+    std::vector<LocalCache*> caches;   /* registered thread caches, under mutex */
+};
+
+/* InputStream: read stream from source asyn into pooled slabs and then hand every
+ * filled slab to the callback. The callback may keep the SlabRef as long as it needs. */
+class InputStream{
+
+public:
+    InputStream(BufferPool& _pool):pool(_pool){}
+
+    void read_async(size_t total_bytes, std::function<void(BufferPool::SlabRef)> callback){
+        static const char source[] = "Over-Infinity ";
+        size_t pos = 0;
+        while(pos < total_bytes){
+            BufferPool::SlabRef slab = pool.acquire();
+            std::span<char> buf = slab.buffer();
+            size_t n = 0;
+            while(n < buf.size() && pos < total_bytes){
+                size_t off = pos % (sizeof(source) - 1);
+                size_t len = std::min({sizeof(source) - 1 - off, buf.size() - n, total_bytes - pos});
+                std::memcpy(buf.data() + n, source + off, len);
+                n += len;
+                pos += len;
+            }
+            slab.commit(n);
+            callback(std::move(slab));
+        }
+    }
+
+private:
+    BufferPool& pool;
+};
+
+/* DataReader: does not own any content any more, it only looks at the views it gets
+ * and drops the slab as soon as it is done with it. */
+class DataReader{
+
+public:
+    DataReader(BufferPool& pool):stream(pool),bytes(0),checksum(0){}
+
+    void read_stream(size_t total_bytes){
+        stream.read_async(total_bytes, [this](BufferPool::SlabRef slab){ read_done(slab.view()); });
+    }
+
+    void read_done(std::span<const char> chunk){
+        for(char c : chunk) checksum = checksum * 31 + static_cast<unsigned char>(c);
+        bytes += chunk.size();
+    }
+
+    InputStream stream;
+    size_t bytes;
+    uint64_t checksum;
+};
+
+int main(){
+
+    /* 4 KB slabs, at most 64 KB in flight */
+    BufferPool pool(4096, 64 * 1024);
+
+    /* single thread: the same slab keeps coming back from the per-thread free list */
+    DataReader reader(pool);
+    reader.read_stream(64 * 1024 * 1024);
+    std::cout << "read " << reader.bytes << " bytes, checksum " << reader.checksum
+              << ", slabs allocated " << pool.slabs_created() << "\n";
+
+    /* producer/consumer: the reader thread holds slabs for a while, the producer is
+     * throttled by the memory cap instead of growing the heap */
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<BufferPool::SlabRef> queue;
+    bool done = false;
+    size_t consumed = 0;
+
+    std::thread consumer([&]{
+        std::vector<BufferPool::SlabRef> batch;
+        for(;;){
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&]{ return !queue.empty() || done; });
+                if(queue.empty() && done) break;
+                batch.swap(queue);
+            }
+            for(auto& slab : batch) consumed += slab.view().size();
+            batch.clear();
+        }
+    });
+
+    InputStream producer(pool);
+    producer.read_async(256 * 1024 * 1024, [&](BufferPool::SlabRef slab){
+        { std::lock_guard<std::mutex> lock(m); queue.push_back(std::move(slab)); }
+        cv.notify_one();
+    });
+    { std::lock_guard<std::mutex> lock(m); done = true; }
+    cv.notify_one();
+    consumer.join();
+
+    std::cout << "consumed " << consumed << " bytes across threads, slabs allocated "
+              << pool.slabs_created() << "\n";
+
+    /* two threads that both acquire and release on a pool of only 4 slabs: each keeps up
+     * to 2 slabs at a time, so they regularly wait for each other at the cap. A third
+     * thread fills its cache and exits, its slabs must come back to the pool */
+    BufferPool small(4096, 4 * (4096 + 64));
+    std::thread([&]{
+        std::vector<BufferPool::SlabRef> held;
+        for(int i = 0; i < 4; i++) held.push_back(small.acquire());
+    }).join();
+    std::atomic<size_t> rounds{0};
+    auto worker = [&]{
+        for(int i = 0; i < 100000; i++){
+            BufferPool::SlabRef a = small.acquire();
+            BufferPool::SlabRef b = small.acquire();
+            a.commit(a.buffer().size());
+            b.commit(0);
+            rounds++;
+        }
+    };
+    std::thread t1(worker), t2(worker);
+    t1.join();
+    t2.join();
+    bool too_long = false;
+    try{
+        small.acquire().commit(4097);
+    }catch(const std::length_error&){
+        too_long = true;
+    }
+    std::cout << "two threads at the cap: " << rounds << " rounds, slabs allocated "
+              << small.slabs_created() << "\n";
+    if(rounds != 200000 || small.slabs_created() > 4 || !too_long){
+        std::cout << "FAILED\n";
+        return 1;
+    }
+    return 0;
+}
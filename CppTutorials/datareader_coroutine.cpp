@@ -0,0 +1,397 @@
+/*************************************************************************************
+ Copyright (C) 2021 Over-Infinity.
+ Everyone is permitted to copy and distribute verbatim copies of this license document
+ This Sampel shows how to read a stream with c++20 coroutines instead of callbacks
+ (linux, build: g++ -std=c++20 -O2 datareader_coroutine.cpp)
+**************************************************************************************/
+#include <iostream>
+#include <coroutine>
+#include <exception>
+#include <system_error>
+#include <utility>
+#include <deque>
+#include <vector>
+#include <span>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+
+/* In datareader.cpp and datareader_lambda.cpp the stream calls back into DataReader through
+ * std::bind(&DataReader::read_done, this). That is fine for one read, but a reader that has
+ * to read a header and then a body ends up with a chain of callbacks that all capture this.
+ * With coroutines the same reader is written as straight-line code:
+ *
+ *      size_t n = co_await stream.read(header);
+ *      n = co_await stream.read(body);
+ *
+ * The pieces of this sample:
+ *  - FrameAllocator: coroutine frames are allocated by the promise and recycled through
+ *    per-thread free lists, so starting a coroutine does not call malloc in steady state.
+ *  - task<T>: lazy coroutine result, awaiting it starts it and when it finishes it resumes
+ *    the awaiting coroutine by symmetric transfer (no stack growth for long chains).
+ *  - EventLoop: a ready queue plus epoll, it resumes coroutines that wait for a descriptor.
+ *  - InputStream / FdStream: the awaitable read interfaces. */
+
+/* FrameAllocator: size-class free lists (16 byte steps) for coroutine frames. */
+class FrameAllocator{
+
+public:
+    static void* allocate(size_t size){
+        size_t cls = (size + GRANULE - 1) / GRANULE;
+        Stats& s = stats();
+        s.live_bytes += cls * GRANULE;
+        if(s.live_bytes > s.peak_bytes) s.peak_bytes = s.live_bytes;
+        if(cls >= CLASSES) return ::operator new(size);
+        FreeBlock*& head = free_lists()[cls];
+        if(head){
+            FreeBlock* b = head;
+            head = b->next;
+            return b;
+        }
+        s.fresh_allocations++;
+        return ::operator new(cls * GRANULE);
+    }
+
+    static void deallocate(void* p, size_t size){
+        size_t cls = (size + GRANULE - 1) / GRANULE;
+        stats().live_bytes -= cls * GRANULE;
+        if(cls >= CLASSES){ ::operator delete(p); return; }
+        FreeBlock* b = static_cast<FreeBlock*>(p);
+        b->next = free_lists()[cls];
+        free_lists()[cls] = b;
+    }
+
+    struct Stats{
+        size_t live_bytes = 0;
+        size_t peak_bytes = 0;
+        size_t fresh_allocations = 0;
+    };
+    static Stats& stats(){
+        static thread_local Stats s;
+        return s;
+    }
+
+private:
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t CLASSES = 64;   /* frames up to 1 KB are recycled */
+    struct FreeBlock{ FreeBlock* next; };
+    static FreeBlock** free_lists(){
+        static thread_local FreeBlock* lists[CLASSES] = {};
+        return lists;
+    }
+};
+
+/* every promise of this sample gets its frame from FrameAllocator */
+struct RecycledFrame{
+    static void* operator new(size_t size){ return FrameAllocator::allocate(size); }
+    static void operator delete(void* p, size_t size){ FrameAllocator::deallocate(p, size); }
+};
+
+template<typename T>
+class task;
+
+namespace detail{
+
+struct promise_base : RecycledFrame{
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    /* symmetric transfer: hand control straight to whoever awaited us */
+    struct final_awaiter{
+        bool await_ready() noexcept { return false; }
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+    final_awaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception(){ error = std::current_exception(); }
+};
+
+template<typename T>
+struct promise : promise_base{
+    T value{};
+    task<T> get_return_object();
+    void return_value(T v){ value = std::move(v); }
+    T result(){
+        if(error) std::rethrow_exception(error);
+        return std::move(value);
+    }
+};
+
+template<>
+struct promise<void> : promise_base{
+    task<void> get_return_object();
+    void return_void(){}
+    void result(){ if(error) std::rethrow_exception(error); }
+};
+
+} // end namespace detail
+
+template<typename T = void>
+class task{
+
+public:
+    using promise_type = detail::promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit task(handle_type h):handle(h){}
+    task(task&& other) noexcept :handle(std::exchange(other.handle, {})){}
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task(){ if(handle) handle.destroy(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume(){ return handle.promise().result(); }
+
+private:
+    handle_type handle;
+};
+
+template<typename T>
+task<T> detail::promise<T>::get_return_object(){
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+inline task<void> detail::promise<void>::get_return_object(){
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+/* EventLoop: runs ready coroutines and waits on epoll when there is nothing to run. */
+class EventLoop{
+
+public:
+    EventLoop():epfd(epoll_create1(EPOLL_CLOEXEC)),waiting(0),live(0){
+        if(epfd < 0) throw std::system_error(errno, std::generic_category(), "epoll_create1");
+    }
+    ~EventLoop(){ ::close(epfd); }
+
+    /* start a task<void> that nobody awaits, its frame is freed when it finishes */
+    void spawn(task<void> t){ run_detached(*this, std::move(t)); }
+
+    void post(std::coroutine_handle<> h){ ready.push_back(h); }
+
+    /* co_await loop.yield(): go to the back of the ready queue */
+    auto yield(){
+        struct awaiter{
+            EventLoop& loop;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h){ loop.post(h); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{*this};
+    }
+
+    /* co_await loop.readable(fd) / loop.writable(fd) */
+    auto readable(int fd){ return fd_awaiter{*this, fd, EPOLLIN, {}}; }
+    auto writable(int fd){ return fd_awaiter{*this, fd, EPOLLOUT, {}}; }
+
+    void run(){
+        epoll_event events[64];
+        while(live > 0){
+            while(!ready.empty()){
+                std::coroutine_handle<> h = ready.front();
+                ready.pop_front();
+                h.resume();
+            }
+            /* nothing ready and nothing to wait for: the rest can never resume */
+            if(waiting == 0) break;
+            int n = epoll_wait(epfd, events, 64, -1);
+            if(n < 0){
+                if(errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "epoll_wait");
+            }
+            for(int i = 0; i < n; i++){
+                fd_awaiter* w = static_cast<fd_awaiter*>(events[i].data.ptr);
+                epoll_ctl(epfd, EPOLL_CTL_DEL, w->fd, nullptr);
+                waiting--;
+                ready.push_back(w->handle);
+            }
+        }
+    }
+
+private:
+    struct fd_awaiter{
+        EventLoop& loop;
+        int fd;
+        uint32_t events;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h){
+            handle = h;
+            epoll_event ev{};
+            ev.events = events | EPOLLONESHOT;
+            ev.data.ptr = this;
+            if(epoll_ctl(loop.epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+                throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+            loop.waiting++;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    /* detached: fire and forget wrapper used by spawn() */
+    struct detached{
+        struct promise_type : RecycledFrame{
+            detached get_return_object(){ return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void(){}
+            void unhandled_exception(){ std::terminate(); }
+        };
+    };
+    static detached run_detached(EventLoop& loop, task<void> t){
+        loop.live++;
+        co_await t;
+        loop.live--;
+    }
+
+    int epfd;
+    size_t waiting;
+    size_t live;
+    std::deque<std::coroutine_handle<>> ready;
+};
+
+/* InputStream: the same simulated "Over-Infinity" source as datareader.cpp. The read
+ * completes asynchronously on the next turn of the loop, the awaitable lives inside the
+ * caller's frame so it costs no allocation. */
+class InputStream{
+
+public:
+    InputStream(EventLoop& _loop):loop(_loop),pos(0){}
+
+    auto read(std::span<char> buf){
+        struct awaiter{
+            InputStream& stream;
+            std::span<char> buf;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h){ stream.loop.post(h); }
+            size_t await_resume(){ return stream.fill(buf); }
+        };
+        return awaiter{*this, buf};
+    }
+
+private:
+    size_t fill(std::span<char> buf){
+        static const char source[] = "Over-Infinity";
+        for(char& c : buf) c = source[pos++ % (sizeof(source) - 1)];
+        return buf.size();
+    }
+    EventLoop& loop;
+    size_t pos;
+};
+
+/* FdStream: reads a non-blocking file or socket descriptor through the event loop. */
+class FdStream{
+
+public:
+    FdStream(EventLoop& _loop, int _fd):loop(_loop),fd(_fd){
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    /* returns the number of bytes read, 0 at end of stream */
+    task<size_t> read(std::span<char> buf){
+        for(;;){
+            ssize_t n = ::read(fd, buf.data(), buf.size());
+            if(n >= 0) co_return static_cast<size_t>(n);
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+                throw std::system_error(errno, std::generic_category(), "read");
+            co_await loop.readable(fd);
+        }
+    }
+
+    task<size_t> write(std::span<const char> buf){
+        size_t done = 0;
+        while(done < buf.size()){
+            ssize_t n = ::write(fd, buf.data() + done, buf.size() - done);
+            if(n >= 0){ done += n; continue; }
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+                throw std::system_error(errno, std::generic_category(), "write");
+            co_await loop.writable(fd);
+        }
+        co_return done;
+    }
+
+private:
+    EventLoop& loop;
+    int fd;
+};
+
+/* DataReader: the multi-step read that needed two callbacks is now one coroutine */
+task<> read_record(InputStream& stream, size_t& total){
+    char header[4];
+    char body[8];
+    total += co_await stream.read(header);
+    total += co_await stream.read(body);
+}
+
+task<> pipe_writer(FdStream& out, size_t bytes){
+    std::vector<char> chunk(4096, 'x');
+    while(bytes > 0){
+        size_t n = std::min(bytes, chunk.size());
+        co_await out.write(std::span<const char>(chunk.data(), n));
+        bytes -= n;
+    }
+}
+
+task<> pipe_reader(FdStream& in, size_t& total){
+    char buf[4096];
+    for(;;){
+        size_t n = co_await in.read(buf);
+        if(n == 0) break;
+        total += n;
+    }
+}
+
+int main(){
+
+    EventLoop loop;
+
+    /* 100k concurrent readers, every one suspended twice inside the loop */
+    const size_t readers = 100000;
+    InputStream stream(loop);
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < readers; i++)
+        loop.spawn(read_record(stream, total));
+    size_t peak = FrameAllocator::stats().live_bytes;
+    loop.run();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << readers << " coroutines read " << total << " bytes in " << elapsed * 1000 << " ms, "
+              << peak / readers << " bytes of frames per coroutine\n";
+
+    /* the second round reuses the recycled frames, nothing new is allocated */
+    size_t fresh = FrameAllocator::stats().fresh_allocations;
+    for(size_t i = 0; i < readers; i++)
+        loop.spawn(read_record(stream, total));
+    loop.run();
+    std::cout << "second round: " << FrameAllocator::stats().fresh_allocations - fresh
+              << " new frame allocations\n";
+
+    /* the same task<> type driven by a real descriptor (pipe) */
+    int fds[2];
+    if(::pipe(fds) < 0){ perror("pipe"); return 1; }
+    size_t piped = 0;
+    {
+        FdStream in(loop, fds[0]);
+        FdStream out(loop, fds[1]);
+        loop.spawn(pipe_reader(in, piped));
+        loop.spawn([](FdStream& out, size_t bytes, int fd) -> task<> {
+            co_await pipe_writer(out, bytes);
+            ::close(fd);
+        }(out, 16 * 1024 * 1024, fds[1]));
+        loop.run();
+    }
+    ::close(fds[0]);
+    std::cout << "pipe reader got " << piped << " bytes\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Monotonic arena memory resource
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file arena_resource.h
+ *
+ * An arena hands out memory by bumping a pointer through large chunks and never frees a
+ * single allocation. A node-based container that builds on it gets its nodes packed next
+ * to each other in allocation order, and an allocation is a pointer bump with no header
+ * and no free list. deallocate() does nothing. reset() frees everything at once and keeps
+ * the chunks, so the next build reuses the same memory.
+ *
+ * Not thread-safe: use one arena per thread, or wrap it in a lock.
+ */
+
+#ifndef ARENA_RESOURCE_H
+#define ARENA_RESOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace ds
+{
+
+class arena_resource : public std::pmr::memory_resource
+{
+public:
+  explicit arena_resource(size_t initial_chunk = 64 * 1024,
+                          std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream(upstream), next_chunk_size(initial_chunk < 256 ? 256 : initial_chunk)
+  {
+  }
+  arena_resource(const arena_resource&) = delete;
+  arena_resource& operator=(const arena_resource&) = delete;
+  ~arena_resource() override
+  {
+    for (const Chunk& c : chunks) upstream->deallocate(c.begin, c.size, alignof(std::max_align_t));
+  }
+
+  /* forget every allocation, keep the chunks for reuse */
+  void reset()
+  {
+    current = 0;
+    cursor = chunks.empty() ? nullptr : chunks[0].begin;
+    limit = chunks.empty() ? nullptr : chunks[0].begin + chunks[0].size;
+    used = 0;
+  }
+
+  /* bytes handed out since the last reset / bytes taken from upstream */
+  size_t bytes_used() const { return used; }
+  size_t bytes_reserved() const
+  {
+    size_t total = 0;
+    for (const Chunk& c : chunks) total += c.size;
+    return total;
+  }
+
+private:
+  struct Chunk
+  {
+    char* begin;
+    size_t size;
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    char* p = align_up(cursor, alignment);
+    if (!cursor || p + bytes > limit) p = next_chunk(bytes, alignment);
+    cursor = p + bytes;
+    used += bytes;
+    return p;
+  }
+
+  void do_deallocate(void*, size_t, size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  static char* align_up(char* p, size_t alignment)
+  {
+    uintptr_t v = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char*>((v + alignment - 1) & ~(uintptr_t(alignment) - 1));
+  }
+
+  /* move on to the next kept chunk that is big enough, or grow by a new chunk */
+  char* next_chunk(size_t bytes, size_t alignment)
+  {
+    size_t need = bytes + alignment;
+    size_t i = chunks.empty() ? 0 : current + 1;
+    for (; i < chunks.size(); i++)
+      if (chunks[i].size >= need) break;
+    if (i == chunks.size()) {
+      while (next_chunk_size < need) next_chunk_size *= 2;
+      chunks.push_back({static_cast<char*>(upstream->allocate(next_chunk_size, alignof(std::max_align_t))),
+                        next_chunk_size});
+      next_chunk_size *= 2;
+    }
+    current = i;
+    limit = chunks[i].begin + chunks[i].size;
+    return align_up(chunks[i].begin, alignment);
+  }
+
+  std::pmr::memory_resource* upstream;
+  std::vector<Chunk> chunks;
+  size_t current = 0;
+  size_t next_chunk_size;
+  char* cursor = nullptr;
+  char* limit = nullptr;
+  size_t used = 0;
+};
+
+}; // end namespace ds
+#endif // ARENA_RESOURCE_H
@@ -0,0 +1,286 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file benchmark.cpp
+ * @discription build-and-traverse throughput of node-based containers (std::pmr::list,
+ *              std::pmr::set and ds::btree_map) on the default heap, ds::arena_resource,
+ *              ds::pool_resource and std::pmr::unsynchronized_pool_resource; then
+ *              several threads sharing one resource (ds::pool_resource against
+ *              std::pmr::synchronized_pool_resource), several pools used on one thread, and
+ *              threads that come and go: blocks cached by a thread must not be lost when
+ *              it exits, the memory reserved by the pool has to stay flat.
+ *              usage: allocator_benchmark [nodes] [threads] (default 10M, 4 or one per core)
+ */
+
+#include "arena_resource.h"
+#include "counting_resource.h"
+#include "pool_resource.h"
+#include "../Tree/btree_map.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+double ms_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+struct Timing
+{
+  double build, traverse, destroy;
+  int64_t checksum;
+};
+
+/* the heap is first churned with small allocations of mixed size, the way a long running
+ * program leaves it, so nodes from the default allocator do not come out neatly in order */
+void fragment_heap(std::vector<void*>& keep)
+{
+  std::mt19937 rng(11);
+  std::vector<void*> tmp;
+  for (int i = 0; i < 200000; i++) tmp.push_back(std::malloc(16 + rng() % 96));
+  for (size_t i = 0; i < tmp.size(); i++) {
+    if (i % 3) std::free(tmp[i]);
+    else keep.push_back(tmp[i]);
+  }
+}
+
+Timing run_list(std::pmr::memory_resource* resource, const std::vector<int64_t>& values)
+{
+  Timing t{};
+  auto start = clock_type::now();
+  {
+    std::pmr::list<int64_t> list(resource);
+    for (int64_t v : values) list.push_back(v);
+    t.build = ms_since(start);
+    start = clock_type::now();
+    for (int64_t v : list) t.checksum += v;
+    t.traverse = ms_since(start);
+    start = clock_type::now();
+  }
+  t.destroy = ms_since(start);
+  return t;
+}
+
+Timing run_set(std::pmr::memory_resource* resource, const std::vector<int64_t>& values)
+{
+  Timing t{};
+  auto start = clock_type::now();
+  {
+    std::pmr::set<int64_t> set(resource);
+    for (int64_t v : values) set.insert(v);
+    t.build = ms_since(start);
+    start = clock_type::now();
+    for (int64_t v : set) t.checksum += v;
+    t.traverse = ms_since(start);
+    start = clock_type::now();
+  }
+  t.destroy = ms_since(start);
+  return t;
+}
+
+Timing run_btree(std::pmr::memory_resource* resource, const std::vector<int64_t>& values)
+{
+  Timing t{};
+  auto start = clock_type::now();
+  {
+    ds::btree_map<int64_t, int64_t> tree(resource);
+    for (int64_t v : values) tree.insert(v, v);
+    t.build = ms_since(start);
+    start = clock_type::now();
+    for (auto it = tree.begin(); it != tree.end(); ++it) t.checksum += it.value();
+    t.traverse = ms_since(start);
+    start = clock_type::now();
+  }
+  t.destroy = ms_since(start);
+  return t;
+}
+
+template <typename Run>
+void compare(const char* name, Run run, const std::vector<int64_t>& values)
+{
+  std::printf("%s, %zu nodes (ms: build / traverse / destroy)\n", name, values.size());
+  Timing heap = run(std::pmr::new_delete_resource(), values);
+  std::printf("  %-32s %9.1f %9.1f %9.1f\n", "default heap (new/delete)", heap.build, heap.traverse, heap.destroy);
+  {
+    ds::arena_resource arena(1 << 20);
+    Timing t = run(&arena, values);
+    std::printf("  %-32s %9.1f %9.1f %9.1f\n", "ds::arena_resource", t.build, t.traverse, t.destroy);
+    if (t.checksum != heap.checksum) std::exit(1);
+  }
+  {
+    ds::pool_resource pool;
+    Timing t = run(&pool, values);
+    std::printf("  %-32s %9.1f %9.1f %9.1f\n", "ds::pool_resource", t.build, t.traverse, t.destroy);
+    if (t.checksum != heap.checksum) std::exit(1);
+  }
+  {
+    std::pmr::unsynchronized_pool_resource pool;
+    Timing t = run(&pool, values);
+    std::printf("  %-32s %9.1f %9.1f %9.1f\n", "std::pmr::unsynchronized_pool", t.build, t.traverse, t.destroy);
+    if (t.checksum != heap.checksum) std::exit(1);
+  }
+}
+
+/* every thread builds, walks and destroys lists of its share of the values, all on the same resource */
+Timing run_threads(std::pmr::memory_resource* resource, const std::vector<int64_t>& values, unsigned threads)
+{
+  Timing t{};
+  std::vector<int64_t> sums(threads, 0);
+  auto start = clock_type::now();
+  std::vector<std::thread> workers;
+  for (unsigned w = 0; w < threads; w++) {
+    workers.emplace_back([&, w] {
+      size_t begin = values.size() * w / threads, end = values.size() * (w + 1) / threads;
+      for (int round = 0; round < 4; round++) {
+        std::pmr::list<int64_t> list(resource);
+        for (size_t i = begin; i < end; i++) list.push_back(values[i]);
+        for (int64_t v : list) sums[w] += v;
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  t.build = ms_since(start);
+  for (int64_t sum : sums) t.checksum += sum;
+  return t;
+}
+
+/* one btree_map per resource, filled in turns on one thread */
+Timing run_pools(const std::vector<std::pmr::memory_resource*>& resources, const std::vector<int64_t>& values)
+{
+  Timing t{};
+  auto start = clock_type::now();
+  {
+    std::vector<ds::btree_map<int64_t, int64_t>> trees;
+    for (std::pmr::memory_resource* r : resources) trees.emplace_back(r);
+    for (size_t i = 0; i < values.size(); i++) trees[i % trees.size()].insert(values[i], values[i]);
+    t.build = ms_since(start);
+    start = clock_type::now();
+    for (auto& tree : trees)
+      for (auto it = tree.begin(); it != tree.end(); ++it) t.checksum += it.value();
+    t.traverse = ms_since(start);
+    start = clock_type::now();
+  }
+  t.destroy = ms_since(start);
+  return t;
+}
+
+void compare_pools(size_t count, const std::vector<int64_t>& values)
+{
+  std::printf("%zu ds::btree_map on %zu resources, one thread, %zu nodes (ms: build / traverse / destroy)\n", count,
+              count, values.size());
+  int64_t checksum = 0;
+  {
+    std::vector<std::unique_ptr<std::pmr::synchronized_pool_resource>> pools;
+    std::vector<std::pmr::memory_resource*> resources;
+    for (size_t i = 0; i < count; i++) {
+      pools.emplace_back(new std::pmr::synchronized_pool_resource());
+      resources.push_back(pools.back().get());
+    }
+    Timing t = run_pools(resources, values);
+    std::printf("  %-32s %9.1f %9.1f %9.1f\n", "std::pmr::synchronized_pool", t.build, t.traverse, t.destroy);
+    checksum = t.checksum;
+  }
+  {
+    std::vector<std::unique_ptr<ds::pool_resource>> pools;
+    std::vector<std::pmr::memory_resource*> resources;
+    for (size_t i = 0; i < count; i++) {
+      pools.emplace_back(new ds::pool_resource());
+      resources.push_back(pools.back().get());
+    }
+    Timing t = run_pools(resources, values);
+    std::printf("  %-32s %9.1f %9.1f %9.1f\n", "ds::pool_resource", t.build, t.traverse, t.destroy);
+    if (t.checksum != checksum) std::exit(1);
+  }
+}
+
+void compare_threads(unsigned threads, const std::vector<int64_t>& values)
+{
+  std::printf("std::pmr::list, %u threads on one resource, %zu nodes x 4 rounds (ms)\n", threads, values.size());
+  Timing heap = run_threads(std::pmr::new_delete_resource(), values, threads);
+  std::printf("  %-32s %9.1f\n", "default heap (new/delete)", heap.build);
+  {
+    ds::pool_resource pool;
+    Timing t = run_threads(&pool, values, threads);
+    std::printf("  %-32s %9.1f\n", "ds::pool_resource", t.build);
+    if (t.checksum != heap.checksum) std::exit(1);
+  }
+  {
+    std::pmr::synchronized_pool_resource pool;
+    Timing t = run_threads(&pool, values, threads);
+    std::printf("  %-32s %9.1f\n", "std::pmr::synchronized_pool", t.build);
+    if (t.checksum != heap.checksum) std::exit(1);
+  }
+}
+
+/* 1000 short-lived threads one after the other, each leaves blocks in its cache */
+void thread_churn()
+{
+  ds::pool_resource pool;
+  size_t first = 0;
+  for (int t = 0; t < 1000; t++) {
+    std::thread([&] {
+      std::pmr::list<int64_t> list(&pool);
+      for (int i = 0; i < 1000; i++) list.push_back(i);
+      std::pmr::set<int64_t> set(&pool);
+      for (int i = 0; i < 100; i++) set.insert(i);
+    }).join();
+    if (t == 0) first = pool.bytes_reserved();
+  }
+  std::printf("1000 threads of 1100 nodes each, one after the other: ds::pool_resource reserved %zu KB after the "
+              "first, %zu KB after the last\n",
+              first / 1024, pool.bytes_reserved() / 1024);
+  if (pool.bytes_reserved() > first) std::exit(1);
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  size_t nodes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  unsigned threads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 0;
+  if (threads == 0) threads = std::max(4u, std::thread::hardware_concurrency());
+  std::vector<void*> keep;
+  fragment_heap(keep);
+
+  std::mt19937_64 rng(5);
+  std::vector<int64_t> values(nodes);
+  for (int64_t& v : values) v = static_cast<int64_t>(rng() >> 1);
+
+  compare("std::pmr::list", run_list, values);
+  compare("std::pmr::set", run_set, values);
+  compare("ds::btree_map", run_btree, values);
+  compare_threads(threads, values);
+  compare_pools(2, values);
+  compare_pools(6, values);
+  thread_churn();
+
+  /* allocation counters of one build */
+  ds::pool_resource pool;
+  ds::counting_resource counted(&pool);
+  {
+    std::pmr::set<int64_t> set(&counted);
+    for (size_t i = 0; i < nodes && i < 1000000; i++) set.insert(values[i]);
+  }
+  ds::counting_resource::stats s = counted.snapshot();
+  std::printf("std::pmr::set of %zu nodes on the pool: %zu allocations, %zu deallocations, peak %.1f MB, "
+              "pool reserved %.1f MB\n",
+              nodes < 1000000 ? nodes : size_t(1000000), s.allocations, s.deallocations, s.peak_bytes / 1e6,
+              pool.bytes_reserved() / 1e6);
+
+  for (void* p : keep) std::free(p);
+  return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Instrumenting memory resource
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file counting_resource.h
+ *
+ * Forwards every request to an upstream resource and counts it. Put it in front of any
+ * resource (or the default heap) to see how many allocations a container makes and how
+ * much memory it holds at its peak:
+ *
+ *   ds::pool_resource pool;
+ *   ds::counting_resource counted(&pool);
+ *   std::pmr::list<int> list(&counted);
+ */
+
+#ifndef COUNTING_RESOURCE_H
+#define COUNTING_RESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+namespace ds
+{
+
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+  struct stats
+  {
+    size_t allocations;
+    size_t deallocations;
+    size_t bytes_in_use;
+    size_t peak_bytes;
+  };
+
+  explicit counting_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream(upstream)
+  {
+  }
+
+  stats snapshot() const
+  {
+    return {allocations.load(std::memory_order_relaxed), deallocations.load(std::memory_order_relaxed),
+            in_use.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed)};
+  }
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    void* p = upstream->allocate(bytes, alignment);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t now = in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t old = peak.load(std::memory_order_relaxed);
+    while (now > old && !peak.compare_exchange_weak(old, now, std::memory_order_relaxed)) {}
+    return p;
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override
+  {
+    upstream->deallocate(p, bytes, alignment);
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+    in_use.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  std::pmr::memory_resource* upstream;
+  std::atomic<size_t> allocations{0};
+  std::atomic<size_t> deallocations{0};
+  std::atomic<size_t> in_use{0};
+  std::atomic<size_t> peak{0};
+};
+
+}; // end namespace ds
+#endif // COUNTING_RESOURCE_H
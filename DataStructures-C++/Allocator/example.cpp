@@ -0,0 +1,49 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file example.cpp
+ * @discription this example shows how to give node-based containers an arena or a pool
+ */
+
+#include "arena_resource.h"
+#include "counting_resource.h"
+#include "pool_resource.h"
+#include "../Tree/btree_map.h"
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <string>
+
+int main()
+{
+  /* arena: build, use, throw everything away at once, build again in the same memory */
+  ds::arena_resource arena;
+  for (int round = 0; round < 3; round++) {
+    std::pmr::list<int> list(&arena);
+    for (int i = 0; i < 1000; i++) list.push_back(i);
+    std::cout << "round " << round << ": " << arena.bytes_used() << " bytes used, " << arena.bytes_reserved()
+              << " bytes reserved\n";
+    /* the list must be gone before the arena is reset */
+    list.clear();
+    arena.reset();
+  }
+
+  /* pool with counters in front of it, shared by a map and a btree_map */
+  ds::pool_resource pool;
+  ds::counting_resource counted(&pool);
+  {
+    std::pmr::map<int, std::pmr::string> names(&counted);
+    names[1] = "one";
+    names[2] = "two";
+    ds::btree_map<int64_t, int64_t> tree(&counted);
+    for (int64_t i = 0; i < 1000; i++) tree.insert(i, i * i);
+    ds::counting_resource::stats s = counted.snapshot();
+    std::cout << s.allocations << " allocations, " << s.bytes_in_use << " bytes in use\n";
+  }
+  ds::counting_resource::stats s = counted.snapshot();
+  std::cout << "after the containers are gone: " << s.deallocations << " deallocations, " << s.bytes_in_use
+            << " bytes in use, peak " << s.peak_bytes << "\n";
+  return 0;
+}
@@ -0,0 +1,303 @@
+/*
+ * Size-class pool memory resource with thread-local caches
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file pool_resource.h
+ *
+ * Requests up to MAX_SMALL bytes are rounded up to a multiple of 16 (and of their alignment,
+ * up to a cache line) and served from the free list of that size class. Blocks of one class
+ * are carved out of 64 KB chunks, so nodes of the same type sit together instead of being
+ * scattered over the heap.
+ *
+ *   thread cache  : head[class] / count[class]    no lock, most allocations end here
+ *   central lists : one mutex + free list per class, refilled from new chunks
+ *
+ * A thread that finds its cache empty takes BATCH blocks from the central list at once, and
+ * a cache that grows past CACHE_LIMIT gives BATCH blocks back. Each thread has CACHE_SLOTS
+ * caches, one per pool it uses; a pool that finds all slots of a thread taken by live pools
+ * goes to the central lists, and the thread remembers that until some pool is destroyed.
+ * A thread that exits gives the blocks left in its caches back to the central lists of
+ * the pools that are still alive.
+ * Larger or over-aligned requests are passed to the upstream resource.
+ */
+
+#ifndef POOL_RESOURCE_H
+#define POOL_RESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace ds
+{
+
+class pool_resource : public std::pmr::memory_resource
+{
+public:
+  static constexpr size_t GRANULE = 16;
+  static constexpr size_t CLASSES = 32;
+  static constexpr size_t MAX_SMALL = GRANULE * CLASSES;   /* 512 bytes */
+  static constexpr size_t MAX_ALIGN = 64;
+
+  explicit pool_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : upstream(upstream), id(next_id().fetch_add(1) + 1)
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry().insert(id);
+  }
+  pool_resource(const pool_resource&) = delete;
+  pool_resource& operator=(const pool_resource&) = delete;
+  ~pool_resource() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex());
+      registry().erase(id);
+    }
+    /* a slot of a destroyed pool can be claimed again */
+    generation().fetch_add(1, std::memory_order_release);
+    for (ThreadCache& tc : caches().slot)
+      if (tc.owner == id) tc = ThreadCache();
+    for (void* c : chunks) upstream->deallocate(c, CHUNK, MAX_ALIGN);
+  }
+
+  size_t bytes_reserved() const
+  {
+    std::lock_guard<std::mutex> lock(chunk_mutex);
+    return chunks.size() * CHUNK;
+  }
+
+private:
+  static constexpr size_t CHUNK = 64 * 1024;
+  static constexpr size_t BATCH = 32;
+  static constexpr size_t CACHE_LIMIT = 4 * BATCH;
+  static constexpr size_t CACHE_SLOTS = 4;
+
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+  struct alignas(64) Central
+  {
+    std::mutex mutex;
+    FreeBlock* head = nullptr;
+  };
+  struct ThreadCache
+  {
+    uint64_t owner = 0;
+    pool_resource* pool = nullptr;    /* only used while registry() still holds owner */
+    FreeBlock* head[CLASSES] = {};
+    uint32_t count[CLASSES] = {};
+  };
+  struct ThreadCaches
+  {
+    ThreadCache slot[CACHE_SLOTS];
+    /* pool that found no free slot, and generation() at that time */
+    uint64_t miss_owner = 0;
+    uint64_t miss_generation = 0;
+
+    /* thread exit: a pool cannot be destroyed while registry_mutex() is held, it takes
+     * it to leave registry() first */
+    ~ThreadCaches()
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex());
+      for (ThreadCache& tc : slot)
+        if (tc.owner != 0 && registry().count(tc.owner))
+          for (size_t cls = 0; cls < CLASSES; cls++) tc.pool->give_back(tc, cls);
+    }
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    size_t cls = size_class(bytes, alignment);
+    if (cls >= CLASSES) return upstream->allocate(bytes, alignment);
+    ThreadCache* tc = own_cache();
+    if (!tc) return pop_central(cls);
+    if (!tc->head[cls]) refill(*tc, cls);
+    FreeBlock* b = tc->head[cls];
+    tc->head[cls] = b->next;
+    tc->count[cls]--;
+    return b;
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override
+  {
+    size_t cls = size_class(bytes, alignment);
+    if (cls >= CLASSES) {
+      upstream->deallocate(p, bytes, alignment);
+      return;
+    }
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    ThreadCache* tc = own_cache();
+    if (!tc) {
+      std::lock_guard<std::mutex> lock(central[cls].mutex);
+      b->next = central[cls].head;
+      central[cls].head = b;
+      return;
+    }
+    b->next = tc->head[cls];
+    tc->head[cls] = b;
+    if (++tc->count[cls] > CACHE_LIMIT) flush(*tc, cls);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+  /* blocks of a class whose size is a multiple of the alignment are aligned, because
+   * chunks are MAX_ALIGN aligned; CLASSES or more means "not pooled" */
+  static size_t size_class(size_t bytes, size_t alignment)
+  {
+    if (alignment > MAX_ALIGN) return CLASSES;
+    if (alignment > GRANULE) bytes = (bytes + alignment - 1) & ~(alignment - 1);
+    return bytes ? (bytes - 1) / GRANULE : 0;
+  }
+
+  /* the calling thread's cache of this pool, claiming a free slot (or one of a destroyed
+   * pool) the first time; nullptr when all slots belong to live pools */
+  ThreadCache* own_cache()
+  {
+    ThreadCaches& tcs = caches();
+    for (ThreadCache& tc : tcs.slot)
+      if (tc.owner == id) return &tc;
+    uint64_t gen = generation().load(std::memory_order_acquire);
+    if (tcs.miss_owner == id && tcs.miss_generation == gen) return nullptr;
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    for (ThreadCache& tc : tcs.slot) {
+      /* the owner may be gone, its blocks went with its chunks */
+      if (tc.owner == 0 || !registry().count(tc.owner)) {
+        tc = ThreadCache();
+        tc.owner = id;
+        tc.pool = this;
+        return &tc;
+      }
+    }
+    tcs.miss_owner = id;
+    tcs.miss_generation = gen;
+    return nullptr;
+  }
+
+  void refill(ThreadCache& tc, size_t cls)
+  {
+    Central& c = central[cls];
+    std::unique_lock<std::mutex> lock(c.mutex);
+    if (!c.head) {
+      lock.unlock();
+      FreeBlock* list = carve(cls);
+      lock.lock();
+      /* append the new blocks behind whatever another thread freed meanwhile */
+      FreeBlock* tail = list;
+      while (tail->next) tail = tail->next;
+      tail->next = c.head;
+      c.head = list;
+    }
+    /* the cache is empty here: move the first BATCH blocks over as they are, so fresh
+     * blocks keep their address order and consecutive nodes stay adjacent */
+    FreeBlock* last = c.head;
+    uint32_t n = 1;
+    while (n < BATCH && last->next) {
+      last = last->next;
+      n++;
+    }
+    tc.head[cls] = c.head;
+    tc.count[cls] = n;
+    c.head = last->next;
+    last->next = nullptr;
+  }
+
+  void flush(ThreadCache& tc, size_t cls)
+  {
+    FreeBlock* first = tc.head[cls];
+    FreeBlock* last = first;
+    for (size_t i = 1; i < BATCH; i++) last = last->next;
+    tc.head[cls] = last->next;
+    tc.count[cls] -= BATCH;
+    std::lock_guard<std::mutex> lock(central[cls].mutex);
+    last->next = central[cls].head;
+    central[cls].head = first;
+  }
+
+  /* the whole list of a class back to the central list */
+  void give_back(ThreadCache& tc, size_t cls)
+  {
+    FreeBlock* first = tc.head[cls];
+    if (!first) return;
+    FreeBlock* last = first;
+    while (last->next) last = last->next;
+    tc.head[cls] = nullptr;
+    tc.count[cls] = 0;
+    std::lock_guard<std::mutex> lock(central[cls].mutex);
+    last->next = central[cls].head;
+    central[cls].head = first;
+  }
+
+  void* pop_central(size_t cls)
+  {
+    Central& c = central[cls];
+    std::unique_lock<std::mutex> lock(c.mutex);
+    if (!c.head) {
+      lock.unlock();
+      FreeBlock* list = carve(cls);
+      lock.lock();
+      FreeBlock* tail = list;
+      while (tail->next) tail = tail->next;
+      tail->next = c.head;
+      c.head = list;
+    }
+    FreeBlock* b = c.head;
+    c.head = b->next;
+    return b;
+  }
+
+  /* a new chunk cut into blocks of one class, returned as a linked list in address order */
+  FreeBlock* carve(size_t cls)
+  {
+    size_t block = (cls + 1) * GRANULE;
+    char* chunk = static_cast<char*>(upstream->allocate(CHUNK, MAX_ALIGN));
+    {
+      std::lock_guard<std::mutex> lock(chunk_mutex);
+      chunks.push_back(chunk);
+    }
+    size_t n = CHUNK / block;
+    for (size_t i = 0; i + 1 < n; i++)
+      reinterpret_cast<FreeBlock*>(chunk + i * block)->next = reinterpret_cast<FreeBlock*>(chunk + (i + 1) * block);
+    reinterpret_cast<FreeBlock*>(chunk + (n - 1) * block)->next = nullptr;
+    return reinterpret_cast<FreeBlock*>(chunk);
+  }
+
+  static ThreadCaches& caches()
+  {
+    static thread_local ThreadCaches tcs;
+    return tcs;
+  }
+  static std::atomic<uint64_t>& generation()
+  {
+    static std::atomic<uint64_t> g{0};
+    return g;
+  }
+  static std::atomic<uint64_t>& next_id()
+  {
+    static std::atomic<uint64_t> n{0};
+    return n;
+  }
+  static std::set<uint64_t>& registry()
+  {
+    static std::set<uint64_t> ids;
+    return ids;
+  }
+  static std::mutex& registry_mutex()
+  {
+    static std::mutex m;
+    return m;
+  }
+
+  std::pmr::memory_resource* upstream;
+  const uint64_t id;
+  Central central[CLASSES];
+  mutable std::mutex chunk_mutex;
+  std::vector<void*> chunks;
+};
+
+}; // end namespace ds
+#endif // POOL_RESOURCE_H
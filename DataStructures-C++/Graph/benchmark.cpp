@@ -0,0 +1,196 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file benchmark.cpp
+ * @discription builds an R-MAT graph (2^scale vertices, 16 * 2^scale undirected edges),
+ *              compares the memory and BFS traversal rate (edges/sec) of ds::csr_graph with
+ *              a std::vector<std::vector<>> adjacency list, and checks every BFS tree.
+ *              A 2D grid of about as many vertices, searched from a corner, is the
+ *              high-diameter case (thousands of small levels, like a road network).
+ *              usage: graph_benchmark [scale] [threads] (default scale 20, all cores)
+ */
+
+#include "csr_graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+using vertex_t = ds::csr_graph::vertex_t;
+
+double seconds_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/* R-MAT: recursively drop every edge into one quadrant of the adjacency matrix with
+ * probabilities a, b, c, d, which gives the skewed degrees of real-world graphs */
+std::vector<ds::csr_graph::edge_t> rmat_edges(unsigned scale, size_t edge_factor, uint64_t seed)
+{
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  const double a = 0.57, b = 0.19, c = 0.19;
+  std::vector<ds::csr_graph::edge_t> edges(edge_factor << scale);
+  for (auto& e : edges) {
+    vertex_t u = 0, v = 0;
+    for (unsigned bit = 0; bit < scale; bit++) {
+      double r = uni(rng);
+      u = u << 1 | (r >= a + b);
+      v = v << 1 | ((r >= a && r < a + b) || r >= a + b + c);
+    }
+    e = {u, v};
+  }
+  /* relabel so the hubs are not all at the low vertex ids */
+  std::vector<vertex_t> perm(size_t(1) << scale);
+  for (size_t i = 0; i < perm.size(); i++) perm[i] = vertex_t(i);
+  std::shuffle(perm.begin(), perm.end(), rng);
+  for (auto& e : edges) e = {perm[e.first], perm[e.second]};
+  return edges;
+}
+
+/* baseline: adjacency list and a serial queue BFS, returns the level of every vertex */
+std::vector<int64_t> list_bfs(const std::vector<std::vector<vertex_t>>& adj, vertex_t source)
+{
+  std::vector<int64_t> level(adj.size(), -1);
+  std::queue<vertex_t> queue;
+  level[source] = 0;
+  queue.push(source);
+  while (!queue.empty()) {
+    vertex_t v = queue.front();
+    queue.pop();
+    for (vertex_t w : adj[v])
+      if (level[w] < 0) {
+        level[w] = level[v] + 1;
+        queue.push(w);
+      }
+  }
+  return level;
+}
+
+/* a BFS tree is valid when every reached vertex's parent is a neighbour one level up */
+bool valid_tree(const ds::csr_graph& g, const std::vector<int64_t>& parent, const std::vector<int64_t>& level)
+{
+  for (size_t v = 0; v < parent.size(); v++) {
+    if ((parent[v] < 0) != (level[v] < 0)) return false;
+    if (parent[v] < 0 || level[v] == 0) continue;
+    vertex_t p = vertex_t(parent[v]);
+    if (level[p] != level[v] - 1) return false;
+    if (!std::binary_search(g.neighbors_begin(p), g.neighbors_end(p), vertex_t(v))) return false;
+  }
+  return true;
+}
+
+/* grid of side x side vertices, BFS from a corner: 2 * side - 1 levels of at most side vertices */
+bool grid_bfs(unsigned scale, unsigned threads)
+{
+  const size_t side = size_t(1) << (scale / 2), n = side * side;
+  std::vector<ds::csr_graph::edge_t> edges;
+  for (size_t y = 0; y < side; y++)
+    for (size_t x = 0; x < side; x++) {
+      if (x + 1 < side) edges.emplace_back(vertex_t(y * side + x), vertex_t(y * side + x + 1));
+      if (y + 1 < side) edges.emplace_back(vertex_t(y * side + x), vertex_t((y + 1) * side + x));
+    }
+  ds::csr_graph g = ds::csr_graph::from_edges(n, edges, true, threads);
+  std::vector<std::vector<vertex_t>> adj(n);
+  for (auto& e : edges) {
+    adj[e.first].push_back(e.second);
+    adj[e.second].push_back(e.first);
+  }
+
+  auto start = clock_type::now();
+  std::vector<int64_t> level = list_bfs(adj, 0);
+  double list_time = seconds_since(start);
+  start = clock_type::now();
+  ds::bfs_stats stats;
+  std::vector<int64_t> parent = ds::bfs(g, 0, threads, &stats);
+  double csr_time = seconds_since(start);
+  start = clock_type::now();
+  ds::bfs(g, 0, 1);
+  double csr1_time = seconds_since(start);
+  if (!valid_tree(g, parent, level)) {
+    std::fprintf(stderr, "invalid BFS tree on the grid\n");
+    return false;
+  }
+  std::printf("grid %zu x %zu: %zu levels, adjacency list %.1f ms, csr 1 thread %.1f ms, csr %u threads %.1f ms\n", side,
+              side, stats.levels, list_time * 1e3, csr1_time * 1e3, threads, csr_time * 1e3);
+  return true;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned scale = argc > 1 ? unsigned(std::strtoul(argv[1], nullptr, 10)) : 20;
+  unsigned threads = argc > 2 ? unsigned(std::strtoul(argv[2], nullptr, 10)) : ds::default_threads();
+  const size_t n = size_t(1) << scale;
+
+  auto start = clock_type::now();
+  auto edges = rmat_edges(scale, 16, 1);
+  std::printf("R-MAT scale %u: %zu vertices, %zu edges generated in %.2f s\n", scale, n, edges.size(),
+              seconds_since(start));
+
+  start = clock_type::now();
+  ds::csr_graph g = ds::csr_graph::from_edges(n, edges, true, threads);
+  double csr_build = seconds_since(start);
+
+  start = clock_type::now();
+  std::vector<std::vector<vertex_t>> adj(n);
+  for (auto& e : edges) {
+    adj[e.first].push_back(e.second);
+    adj[e.second].push_back(e.first);
+  }
+  double list_build = seconds_since(start);
+  size_t list_bytes = n * sizeof(std::vector<vertex_t>);
+  for (auto& l : adj) list_bytes += l.capacity() * sizeof(vertex_t);
+  edges = std::vector<ds::csr_graph::edge_t>();
+
+  std::printf("build : csr %.2f s (%u threads), adjacency list %.2f s\n", csr_build, threads, list_build);
+  std::printf("memory: csr %.1f MB, adjacency list %.1f MB\n", g.memory_bytes() / 1e6, list_bytes / 1e6);
+
+  std::mt19937_64 rng(3);
+  double list_time = 0, csr_time = 0, csr1_time = 0;
+  size_t traversed = 0;
+  const int RUNS = 8;
+  for (int run = 0; run < RUNS; run++) {
+    vertex_t source;
+    do source = vertex_t(rng() % n); while (g.degree(source) == 0);
+
+    start = clock_type::now();
+    std::vector<int64_t> level = list_bfs(adj, source);
+    list_time += seconds_since(start);
+
+    start = clock_type::now();
+    ds::bfs_stats stats;
+    std::vector<int64_t> parent = ds::bfs(g, source, threads, &stats);
+    csr_time += seconds_since(start);
+
+    start = clock_type::now();
+    ds::bfs(g, source, 1);
+    csr1_time += seconds_since(start);
+
+    if (!valid_tree(g, parent, level)) {
+      std::fprintf(stderr, "invalid BFS tree from source %u\n", source);
+      return 1;
+    }
+    /* edges/sec counts the edges of the reached component, as Graph500 does */
+    size_t component_edges = 0;
+    for (size_t v = 0; v < n; v++)
+      if (level[v] >= 0) component_edges += g.degree(vertex_t(v));
+    traversed += component_edges;
+    if (run == 0)
+      std::printf("bfs   : %zu levels (%zu top-down, %zu bottom-up), %zu vertices reached, %.1f%% of edges examined\n",
+                  stats.levels, stats.top_down_levels, stats.bottom_up_levels, stats.reached,
+                  100.0 * stats.edges_examined / component_edges);
+  }
+  std::printf("edges/sec: adjacency list %.1f M, csr 1 thread %.1f M, csr %u threads %.1f M\n",
+              traversed / list_time / 1e6, traversed / csr1_time / 1e6, threads, traversed / csr_time / 1e6);
+  return grid_bfs(scale, threads) ? 0 : 1;
+}
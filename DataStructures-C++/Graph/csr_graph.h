@@ -0,0 +1,400 @@
+/*
+ * Compressed sparse row graph and direction-optimizing BFS
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file csr_graph.h
+ *
+ * CSR keeps the whole graph in two flat arrays:
+ *
+ *   offsets : [0, 3, 5, 5, 8, ...]          num_vertices + 1 entries
+ *   targets : [1 4 7 | 0 2 | | 3 5 6 | ...]  neighbours of v are targets[offsets[v] .. offsets[v+1])
+ *
+ * That is 4 bytes per edge and 8 bytes per vertex, with no node or pointer per edge. A
+ * vertex's neighbours sit next to each other in memory, so a traversal streams through
+ * them. The arrays are built from an edge list with a parallel counting sort: count the
+ * degrees, prefix-sum them into offsets, then scatter every edge to its slot.
+ *
+ * bfs() is Beamer's direction-optimizing BFS:
+ *  - top-down: every frontier vertex claims its unvisited neighbours (CAS on parent).
+ *    This is cheap while the frontier is small.
+ *  - bottom-up: every unvisited vertex looks for any neighbour in the frontier (a bitmap)
+ *    and stops at the first one. This is cheap when the frontier is a large part of the
+ *    graph, because most edges are never looked at.
+ * The search switches to bottom-up when the frontier's edges outnumber the unexplored
+ * edges / ALPHA, and switches back when the frontier shrinks below num_vertices / BETA.
+ * The threads are started once per bfs() (worker_team), and a top-down level whose
+ * frontier has fewer than SERIAL_EDGES edges runs on the calling thread alone, so that
+ * graphs with thousands of small levels (road networks, chains) do not pay a thread
+ * hand-off per level.
+ */
+
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ds
+{
+
+/* runs f(begin, end, thread_id) on `threads` contiguous chunks of [0, n) */
+template <typename F>
+void parallel_for(size_t n, unsigned threads, F&& f)
+{
+  if (threads <= 1 || n < 2 * threads) {
+    f(size_t(0), n, 0u);
+    return;
+  }
+  std::vector<std::thread> pool;
+  size_t chunk = (n + threads - 1) / threads;
+  for (unsigned t = 1; t < threads; t++) {
+    size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+    pool.emplace_back([&f, begin, end, t] { f(begin, end, t); });
+  }
+  f(size_t(0), std::min(n, chunk), 0u);
+  for (std::thread& th : pool) th.join();
+}
+
+/* threads that are started once and then run many parallel loops, for the levels of one
+ * bfs(): a level costs a wake-up and a join through one mutex instead of creating and
+ * joining threads. run() has the contract of parallel_for(). */
+class worker_team
+{
+public:
+  explicit worker_team(unsigned threads) : threads_(std::max(threads, 1u))
+  {
+    for (unsigned t = 1; t < threads_; t++) workers.emplace_back([this, t] { work(t); });
+  }
+  worker_team(const worker_team&) = delete;
+  worker_team& operator=(const worker_team&) = delete;
+  ~worker_team()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    start_cv.notify_all();
+    for (std::thread& th : workers) th.join();
+  }
+
+  unsigned threads() const { return threads_; }
+
+  template <typename F>
+  void run(size_t n, F&& f)
+  {
+    if (threads_ <= 1 || n < 2 * threads_) {
+      f(size_t(0), n, 0u);
+      return;
+    }
+    using Fn = std::remove_reference_t<F>;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      job = [](void* ctx, size_t b, size_t e, unsigned t) { (*static_cast<Fn*>(ctx))(b, e, t); };
+      job_ctx = &f;
+      job_n = n;
+      pending = threads_ - 1;
+      generation++;
+    }
+    start_cv.notify_all();
+    size_t chunk = (n + threads_ - 1) / threads_;
+    f(size_t(0), std::min(n, chunk), 0u);
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this] { return pending == 0; });
+  }
+
+private:
+  void work(unsigned t)
+  {
+    uint64_t seen = 0;
+    for (;;) {
+      void (*fn)(void*, size_t, size_t, unsigned);
+      void* ctx;
+      size_t n;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        start_cv.wait(lock, [&] { return stop || generation != seen; });
+        if (stop) return;
+        seen = generation;
+        fn = job;
+        ctx = job_ctx;
+        n = job_n;
+      }
+      size_t chunk = (n + threads_ - 1) / threads_;
+      size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+      fn(ctx, begin, end, t);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--pending == 0) done_cv.notify_one();
+    }
+  }
+
+  const unsigned threads_;
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable start_cv, done_cv;
+  void (*job)(void*, size_t, size_t, unsigned) = nullptr;
+  void* job_ctx = nullptr;
+  size_t job_n = 0;
+  unsigned pending = 0;
+  uint64_t generation = 0;
+  bool stop = false;
+};
+
+inline unsigned default_threads()
+{
+  unsigned n = std::thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+class csr_graph
+{
+public:
+  using vertex_t = uint32_t;
+  using edge_t = std::pair<vertex_t, vertex_t>;
+
+  csr_graph() = default;
+
+  /* builds the graph; an undirected graph stores every edge in both directions. For a
+   * directed graph the reverse (in-edge) arrays are built as well, bottom-up BFS needs them. */
+  static csr_graph from_edges(size_t num_vertices, const std::vector<edge_t>& edges, bool undirected = true,
+                              unsigned threads = default_threads())
+  {
+    threads = std::max(threads, 1u);
+    csr_graph g;
+    g.n = num_vertices;
+    g.directed = !undirected;
+    build(num_vertices, edges, undirected, false, threads, g.out_offsets, g.out_targets);
+    if (g.directed) build(num_vertices, edges, false, true, threads, g.in_offsets, g.in_targets);
+    return g;
+  }
+
+  size_t num_vertices() const { return n; }
+  size_t num_edges() const { return out_targets.size(); }
+  bool is_directed() const { return directed; }
+
+  size_t degree(vertex_t v) const { return out_offsets[v + 1] - out_offsets[v]; }
+  const vertex_t* neighbors_begin(vertex_t v) const { return out_targets.data() + out_offsets[v]; }
+  const vertex_t* neighbors_end(vertex_t v) const { return out_targets.data() + out_offsets[v + 1]; }
+
+  /* in-neighbours, the same as the neighbours for an undirected graph */
+  const vertex_t* in_neighbors_begin(vertex_t v) const
+  {
+    return directed ? in_targets.data() + in_offsets[v] : neighbors_begin(v);
+  }
+  const vertex_t* in_neighbors_end(vertex_t v) const
+  {
+    return directed ? in_targets.data() + in_offsets[v + 1] : neighbors_end(v);
+  }
+
+  size_t memory_bytes() const
+  {
+    return (out_offsets.size() + in_offsets.size()) * sizeof(uint64_t) +
+           (out_targets.size() + in_targets.size()) * sizeof(vertex_t);
+  }
+
+private:
+  static void build(size_t n, const std::vector<edge_t>& edges, bool both_directions, bool reverse, unsigned threads,
+                    std::vector<uint64_t>& offsets, std::vector<vertex_t>& targets)
+  {
+    /* 1. degrees */
+    std::unique_ptr<std::atomic<uint64_t>[]> degree(new std::atomic<uint64_t>[n]);
+    parallel_for(n, threads, [&](size_t b, size_t e, unsigned) {
+      for (size_t v = b; v < e; v++) degree[v].store(0, std::memory_order_relaxed);
+    });
+    parallel_for(edges.size(), threads, [&](size_t b, size_t e, unsigned) {
+      for (size_t i = b; i < e; i++) {
+        vertex_t src = reverse ? edges[i].second : edges[i].first;
+        degree[src].fetch_add(1, std::memory_order_relaxed);
+        if (both_directions) degree[edges[i].second].fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+
+    /* 2. exclusive prefix sum in two passes: per-chunk totals, then chunk-local sums */
+    offsets.assign(n + 1, 0);
+    std::vector<uint64_t> chunk_sum(threads + 1, 0);
+    parallel_for(n, threads, [&](size_t b, size_t e, unsigned t) {
+      uint64_t s = 0;
+      for (size_t v = b; v < e; v++) s += degree[v].load(std::memory_order_relaxed);
+      chunk_sum[t + 1] = s;
+    });
+    for (unsigned t = 0; t < threads; t++) chunk_sum[t + 1] += chunk_sum[t];
+    parallel_for(n, threads, [&](size_t b, size_t e, unsigned t) {
+      uint64_t s = chunk_sum[t];
+      for (size_t v = b; v < e; v++) {
+        offsets[v] = s;
+        s += degree[v].load(std::memory_order_relaxed);
+        /* degree[] becomes the scatter cursor of v */
+        degree[v].store(offsets[v], std::memory_order_relaxed);
+      }
+    });
+    offsets[n] = chunk_sum[threads];
+
+    /* 3. scatter the edges, then sort each neighbour list for locality */
+    targets.resize(offsets[n]);
+    parallel_for(edges.size(), threads, [&](size_t b, size_t e, unsigned) {
+      for (size_t i = b; i < e; i++) {
+        vertex_t src = reverse ? edges[i].second : edges[i].first;
+        vertex_t dst = reverse ? edges[i].first : edges[i].second;
+        targets[degree[src].fetch_add(1, std::memory_order_relaxed)] = dst;
+        if (both_directions) targets[degree[dst].fetch_add(1, std::memory_order_relaxed)] = src;
+      }
+    });
+    parallel_for(n, threads, [&](size_t b, size_t e, unsigned) {
+      for (size_t v = b; v < e; v++) std::sort(targets.begin() + offsets[v], targets.begin() + offsets[v + 1]);
+    });
+  }
+
+  size_t n = 0;
+  bool directed = false;
+  std::vector<uint64_t> out_offsets, in_offsets;
+  std::vector<vertex_t> out_targets, in_targets;
+};
+
+struct bfs_stats
+{
+  size_t levels = 0;
+  size_t top_down_levels = 0;
+  size_t bottom_up_levels = 0;
+  size_t reached = 0;
+  size_t edges_examined = 0;
+};
+
+/* returns the BFS parent of every vertex, -1 if it was not reached, source is its own parent */
+inline std::vector<int64_t> bfs(const csr_graph& g, csr_graph::vertex_t source, unsigned threads = default_threads(),
+                                bfs_stats* stats = nullptr)
+{
+  using vertex_t = csr_graph::vertex_t;
+  constexpr size_t ALPHA = 15, BETA = 18, SERIAL_EDGES = 4096;
+  const size_t n = g.num_vertices();
+  threads = std::max(threads, 1u);
+  const size_t words = (n + 63) / 64;
+
+  std::vector<int64_t> parent(n, -1);
+  parent[source] = source;
+
+  std::vector<vertex_t> queue{source};
+  std::vector<uint64_t> front(words), next(words);
+  std::vector<std::vector<vertex_t>> local(threads);
+  std::vector<size_t> local_count(threads), local_edges(threads);
+  worker_team team(threads);
+
+  size_t scout = g.degree(source);
+  size_t unexplored_edges = g.num_edges() - scout;
+  size_t frontier_size = 1;
+  bool bottom_up = false, last_bottom_up = false;
+  bfs_stats st;
+  st.reached = 1;
+
+  while (frontier_size > 0) {
+    st.levels++;
+    if (!bottom_up && scout > unexplored_edges / ALPHA) {
+      /* queue -> bitmap */
+      std::fill(front.begin(), front.end(), 0);
+      for (vertex_t v : queue) front[v >> 6] |= uint64_t(1) << (v & 63);
+      bottom_up = true;
+    }
+    last_bottom_up = bottom_up;
+
+    if (bottom_up) {
+      st.bottom_up_levels++;
+      /* each thread owns whole 64-vertex words of next, so no atomics are needed */
+      team.run(words, [&](size_t wb, size_t we, unsigned t) {
+        size_t found = 0, examined = 0;
+        for (size_t w = wb; w < we; w++) {
+          uint64_t bits = 0;
+          size_t vend = std::min(n, (w + 1) * 64);
+          for (size_t v = w * 64; v < vend; v++) {
+            if (parent[v] >= 0) continue;
+            for (const vertex_t* u = g.in_neighbors_begin(vertex_t(v)); u != g.in_neighbors_end(vertex_t(v)); ++u) {
+              examined++;
+              if (front[*u >> 6] >> (*u & 63) & 1) {
+                parent[v] = *u;
+                bits |= uint64_t(1) << (v & 63);
+                found++;
+                break;
+              }
+            }
+          }
+          next[w] = bits;
+        }
+        local_count[t] = found;
+        local_edges[t] = examined;
+      });
+      size_t old_size = frontier_size;
+      frontier_size = 0;
+      for (unsigned t = 0; t < threads; t++) {
+        frontier_size += local_count[t];
+        st.edges_examined += local_edges[t];
+        local_count[t] = local_edges[t] = 0;
+      }
+      front.swap(next);
+      st.reached += frontier_size;
+
+      if (frontier_size < n / BETA && frontier_size < old_size) {
+        /* bitmap -> queue */
+        queue.clear();
+        for (size_t w = 0; w < words; w++)
+          for (uint64_t bits = front[w]; bits; bits &= bits - 1) queue.push_back(vertex_t(w * 64 + __builtin_ctzll(bits)));
+        scout = 0;
+        for (vertex_t v : queue) scout += g.degree(v);
+        bottom_up = false;
+      }
+    } else {
+      st.top_down_levels++;
+      auto top_down = [&](size_t b, size_t e, unsigned t) {
+        std::vector<vertex_t>& out = local[t];
+        size_t edges = 0, examined = 0;
+        for (size_t i = b; i < e; i++) {
+          vertex_t v = queue[i];
+          for (const vertex_t* w = g.neighbors_begin(v); w != g.neighbors_end(v); ++w) {
+            examined++;
+            int64_t expected = -1;
+            if (__atomic_load_n(&parent[*w], __ATOMIC_RELAXED) < 0 &&
+                __atomic_compare_exchange_n(&parent[*w], &expected, int64_t(v), false, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+              out.push_back(*w);
+              edges += g.degree(*w);
+            }
+          }
+        }
+        local_count[t] = edges;
+        local_edges[t] = examined;
+      };
+      if (scout < SERIAL_EDGES)
+        top_down(0, queue.size(), 0u);
+      else
+        team.run(queue.size(), top_down);
+      queue.clear();
+      scout = 0;
+      for (unsigned t = 0; t < threads; t++) {
+        queue.insert(queue.end(), local[t].begin(), local[t].end());
+        local[t].clear();
+        scout += local_count[t];
+        st.edges_examined += local_edges[t];
+        local_count[t] = local_edges[t] = 0;
+      }
+      unexplored_edges -= std::min(unexplored_edges, scout);
+      frontier_size = queue.size();
+      st.reached += frontier_size;
+    }
+  }
+  /* the last level found nothing */
+  st.levels--;
+  if (last_bottom_up)
+    st.bottom_up_levels--;
+  else
+    st.top_down_levels--;
+  if (stats) *stats = st;
+  return parent;
+}
+
+}; // end namespace ds
+#endif // CSR_GRAPH_H
@@ -0,0 +1,41 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file example.cpp
+ * @discription this example shows how to build a ds::csr_graph and run a BFS on it
+ */
+
+#include "csr_graph.h"
+
+#include <iostream>
+#include <vector>
+
+int main()
+{
+  /*   0 - 1 - 2      5 - 6
+   *   |   |
+   *   3 - 4                 */
+  std::vector<ds::csr_graph::edge_t> edges = {{0, 1}, {1, 2}, {0, 3}, {1, 4}, {3, 4}, {5, 6}};
+  ds::csr_graph g = ds::csr_graph::from_edges(7, edges);
+
+  std::cout << g.num_vertices() << " vertices, " << g.num_edges() << " directed edge slots\n";
+  std::cout << "neighbours of 1:";
+  for (const auto* w = g.neighbors_begin(1); w != g.neighbors_end(1); ++w) std::cout << " " << *w;
+  std::cout << "\n";
+
+  std::vector<int64_t> parent = ds::bfs(g, 0);
+  for (size_t v = 0; v < parent.size(); v++) {
+    std::cout << "vertex " << v << ": ";
+    if (parent[v] < 0) {
+      std::cout << "not reachable from 0\n";
+      continue;
+    }
+    std::cout << "path to 0 =";
+    for (int64_t u = int64_t(v); ; u = parent[u]) {
+      std::cout << " " << u;
+      if (parent[u] == u) break;
+    }
+    std::cout << "\n";
+  }
+  return 0;
+}
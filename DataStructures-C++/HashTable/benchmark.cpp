@@ -0,0 +1,99 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file benchmark.cpp
+ * @discription compares ds::flat_hash_map with std::unordered_map for insert, hit lookups
+ *              and miss lookups. usage: hashtable_benchmark [max_keys] (default 10M, the
+ *              sizes run from 1K up to max_keys in steps of 10x, 100M needs ~6 GB of RAM)
+ */
+
+#include "flat_hash_map.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+double ns_per_op(clock_type::time_point start, size_t ops)
+{
+  return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / ops;
+}
+
+struct Result
+{
+  double insert, hit, miss;
+  uint64_t checksum;
+};
+
+template <typename Map>
+Result run(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& probes, const std::vector<uint64_t>& misses)
+{
+  Result r{};
+  Map map;
+  auto start = clock_type::now();
+  for (uint64_t k : keys) map[k] = k;
+  r.insert = ns_per_op(start, keys.size());
+
+  start = clock_type::now();
+  for (uint64_t k : probes) r.checksum += map.find(k)->second;
+  r.hit = ns_per_op(start, probes.size());
+
+  start = clock_type::now();
+  for (uint64_t k : misses) r.checksum += map.find(k) == map.end();
+  r.miss = ns_per_op(start, misses.size());
+  return r;
+}
+
+/* the same hit lookups, issued through the prefetching batch interface */
+double run_batch(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& probes, uint64_t& checksum)
+{
+  ds::flat_hash_map<uint64_t, uint64_t> map;
+  for (uint64_t k : keys) map[k] = k;
+  std::vector<std::pair<const uint64_t, uint64_t>*> out(probes.size());
+  auto start = clock_type::now();
+  map.find_batch(probes.data(), probes.size(), out.data());
+  double ns = ns_per_op(start, probes.size());
+  for (auto* p : out) checksum += p->second;
+  return ns;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  size_t max_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::mt19937_64 rng(42);
+
+  std::printf("%10s | %-26s | %-26s | %-26s | %s\n", "keys", "insert ns (flat / std)", "hit ns (flat / std)",
+              "miss ns (flat / std)", "batch hit ns");
+  for (size_t n = 1000; n <= max_keys; n *= 10) {
+    /* keys are odd, misses even, so a miss is never found by accident */
+    std::vector<uint64_t> keys(n), misses(n);
+    for (size_t i = 0; i < n; i++) {
+      keys[i] = rng() | 1;
+      misses[i] = rng() & ~1ull;
+    }
+    std::vector<uint64_t> probes(keys);
+    std::shuffle(probes.begin(), probes.end(), rng);
+
+    Result flat = run<ds::flat_hash_map<uint64_t, uint64_t>>(keys, probes, misses);
+    Result std_map = run<std::unordered_map<uint64_t, uint64_t>>(keys, probes, misses);
+    uint64_t batch_checksum = 0;
+    double batch = run_batch(keys, probes, batch_checksum);
+    if (flat.checksum != std_map.checksum || batch_checksum + n != flat.checksum) {
+      std::fprintf(stderr, "checksum mismatch at %zu keys\n", n);
+      return 1;
+    }
+    std::printf("%10zu | %10.1f / %-13.1f | %10.1f / %-13.1f | %10.1f / %-13.1f | %.1f\n", n, flat.insert,
+                std_map.insert, flat.hit, std_map.hit, flat.miss, std_map.miss, batch);
+  }
+  return 0;
+}
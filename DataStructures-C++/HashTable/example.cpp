@@ -0,0 +1,40 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file example.cpp
+ * @discription this example shows how to use ds::flat_hash_map
+ */
+
+#include "flat_hash_map.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+int main()
+{
+  ds::flat_hash_map<std::string, int> ages;
+  ages["alice"] = 31;
+  ages.try_emplace("bob", 27);
+  ages.insert({"carol", 45});
+
+  /* heterogeneous lookup: no std::string is built for the key */
+  std::string_view name = "bob";
+  if (auto it = ages.find(name); it != ages.end())
+    std::cout << it->first << " is " << it->second << "\n";
+  std::cout << "contains \"dave\": " << ages.contains("dave") << "\n";
+
+  ages.erase("alice");
+  for (const auto& [who, age] : ages)
+    std::cout << who << " : " << age << "\n";
+
+  /* batched lookup of several keys at once */
+  ds::flat_hash_map<int, int> squares;
+  for (int i = 0; i < 1000; i++) squares[i] = i * i;
+  int keys[] = {3, 999, 1000, 42};
+  std::pair<const int, int>* found[4];
+  squares.find_batch(keys, 4, found);
+  for (int i = 0; i < 4; i++)
+    std::cout << keys[i] << " -> " << (found[i] ? std::to_string(found[i]->second) : "not found") << "\n";
+  return 0;
+}
@@ -0,0 +1,547 @@
+/*
+ * Swiss-table style open-addressing hash map
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file flat_hash_map.h
+ *
+ * Layout:
+ *   ctrl  [c0 c1 c2 ... c15][c16 ... c31] ...   one control byte per slot, in groups of 16
+ *   slots [s0 s1 s2 ... s15][s16 ... s31] ...   key/value pairs, stored flat (no nodes)
+ *
+ * A control byte is EMPTY (0x80), DELETED (0xFE) or, for a full slot, the low 7 bits of the
+ * hash (h2). The upper bits of the hash (h1) choose the first group, a lookup loads the
+ * 16 control bytes of a group with one SSE2 load and compares all of them against h2 at
+ * once, so only slots whose h2 matches are ever touched. Groups are probed quadratically
+ * and the probe stops at the first group that still has an EMPTY byte.
+ *
+ * Groups stay 16 bytes wide (SSE2 only, no AVX2 path), as in abseil: SSE2 is part of every
+ * x86-64 target, so no build flag or run-time dispatch is needed, and a 32-byte group
+ * would double the smallest table and the slots whose h2 matches by chance on every probe.
+ * Nearly all lookups end in their first group already, so a wider load would rarely
+ * save a probe step.
+ *
+ * Deletion: a group that has an EMPTY byte has never been full, so no probe sequence ever
+ * walked past it. Erasing from such a group can simply write EMPTY; only erasing from a
+ * group that is (or was) full needs a DELETED tombstone.
+ *
+ * Slots are a union of pair<const Key, Value> (what users see) and pair<Key, Value>, so
+ * rehash can move the keys instead of writing through a const Key.
+ */
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FLAT_HASH_MAP_SSE2 1
+#endif
+
+namespace ds
+{
+
+/* hash: std::hash plus a final mix, std::hash<int> is the identity and would leave h2
+ * (the low 7 bits) almost constant for sequential keys. Transparent for strings so a
+ * flat_hash_map<std::string, V> can be searched with a const char* or std::string_view. */
+template <typename K>
+struct hash
+{
+  size_t operator()(const K& key) const noexcept { return mix(std::hash<K>{}(key)); }
+  static size_t mix(size_t h) noexcept
+  {
+    uint64_t x = static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(x ^ (x >> 32));
+  }
+};
+
+template <>
+struct hash<std::string>
+{
+  using is_transparent = void;
+  size_t operator()(std::string_view key) const noexcept
+  {
+    return hash<size_t>::mix(std::hash<std::string_view>{}(key));
+  }
+};
+
+template <typename K>
+struct equal_to
+{
+  bool operator()(const K& a, const K& b) const { return a == b; }
+};
+
+template <>
+struct equal_to<std::string>
+{
+  using is_transparent = void;
+  bool operator()(std::string_view a, std::string_view b) const { return a == b; }
+};
+
+namespace detail
+{
+
+enum ctrl_t : int8_t { EMPTY = -128, DELETED = -2 };
+
+constexpr size_t GROUP_WIDTH = 16;
+
+/* BitMask: one bit per slot of a group, iterated lowest first */
+class BitMask
+{
+public:
+  explicit BitMask(uint32_t m) : mask(m) {}
+  explicit operator bool() const { return mask != 0; }
+  unsigned lowest() const { return static_cast<unsigned>(__builtin_ctz(mask)); }
+  void clear_lowest() { mask &= mask - 1; }
+
+private:
+  uint32_t mask;
+};
+
+/* Group: the 16 control bytes at an aligned position */
+class Group
+{
+public:
+  explicit Group(const int8_t* p)
+  {
+#ifdef FLAT_HASH_MAP_SSE2
+    ctrl = _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+#else
+    std::memcpy(bytes, p, GROUP_WIDTH);
+#endif
+  }
+
+  BitMask match(int8_t h2) const
+  {
+#ifdef FLAT_HASH_MAP_SSE2
+    return BitMask(static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+#else
+    uint32_t m = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; i++)
+      m |= static_cast<uint32_t>(bytes[i] == h2) << i;
+    return BitMask(m);
+#endif
+  }
+
+  BitMask match_empty() const { return match(EMPTY); }
+
+  /* EMPTY and DELETED are the only control values with the sign bit set */
+  BitMask match_empty_or_deleted() const
+  {
+#ifdef FLAT_HASH_MAP_SSE2
+    return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl)));
+#else
+    uint32_t m = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; i++)
+      m |= static_cast<uint32_t>(bytes[i] < 0) << i;
+    return BitMask(m);
+#endif
+  }
+
+private:
+#ifdef FLAT_HASH_MAP_SSE2
+  __m128i ctrl;
+#else
+  int8_t bytes[GROUP_WIDTH];
+#endif
+};
+
+/* probe sequence over group indices: g, g+1, g+3, g+6, ... (visits every group once
+ * because the number of groups is a power of two) */
+class ProbeSeq
+{
+public:
+  ProbeSeq(size_t h1, size_t group_mask) : mask(group_mask), offset(h1 & group_mask), index(0) {}
+  size_t group() const { return offset; }
+  void next()
+  {
+    index++;
+    offset = (offset + index) & mask;
+  }
+
+private:
+  size_t mask;
+  size_t offset;
+  size_t index;
+};
+
+template <typename H, typename E, typename K, typename = void>
+struct is_transparent : std::false_type {};
+template <typename H, typename E, typename K>
+struct is_transparent<H, E, K, std::void_t<typename H::is_transparent, typename E::is_transparent>>
+    : std::true_type {};
+
+} // end namespace detail
+
+template <typename Key, typename Value, typename Hash = ds::hash<Key>, typename KeyEqual = ds::equal_to<Key>>
+class flat_hash_map
+{
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<const Key, Value>;
+  using size_type = size_t;
+
+private:
+  using ctrl_t = detail::ctrl_t;
+  using Group = detail::Group;
+  static constexpr size_t GROUP_WIDTH = detail::GROUP_WIDTH;
+
+  /* heterogeneous lookup is only offered when both Hash and KeyEqual say so */
+  template <typename K>
+  using enable_if_transparent = std::enable_if_t<detail::is_transparent<Hash, KeyEqual, K>::value>;
+
+  /* the slot is always constructed as value; mutable_value is only used to move a key
+   * out of it, which is safe when both pairs are standard layout (common initial sequence) */
+  using mutable_value_type = std::pair<Key, Value>;
+  union slot_type
+  {
+    slot_type() {}
+    ~slot_type() {}
+    value_type value;
+    mutable_value_type mutable_value;
+  };
+  static constexpr bool MUTABLE_KEYS = std::is_standard_layout<value_type>::value &&
+                                       std::is_standard_layout<mutable_value_type>::value;
+
+  static constexpr std::align_val_t SLOT_ALIGN{alignof(slot_type) > 16 ? alignof(slot_type) : 16};
+
+public:
+  template <bool Const>
+  class iterator_impl
+  {
+  public:
+    using value_type = flat_hash_map::value_type;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator_impl() = default;
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    iterator_impl(const iterator_impl<false>& other) : ctrl(other.ctrl), slot(other.slot), end(other.end) {}
+
+    reference operator*() const { return slot->value; }
+    pointer operator->() const { return &slot->value; }
+    iterator_impl& operator++()
+    {
+      ++ctrl;
+      ++slot;
+      skip_free();
+      return *this;
+    }
+    iterator_impl operator++(int)
+    {
+      iterator_impl tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    friend bool operator==(const iterator_impl& a, const iterator_impl& b) { return a.slot == b.slot; }
+    friend bool operator!=(const iterator_impl& a, const iterator_impl& b) { return a.slot != b.slot; }
+
+  private:
+    friend class flat_hash_map;
+    template <bool>
+    friend class iterator_impl;
+    iterator_impl(const int8_t* c, slot_type* s, const int8_t* e) : ctrl(c), slot(s), end(e) {}
+    void skip_free()
+    {
+      while (ctrl != end && *ctrl < 0) {
+        ++ctrl;
+        ++slot;
+      }
+    }
+    const int8_t* ctrl = nullptr;
+    slot_type* slot = nullptr;
+    const int8_t* end = nullptr;
+  };
+
+  using iterator = iterator_impl<false>;
+  using const_iterator = iterator_impl<true>;
+
+  flat_hash_map() = default;
+  explicit flat_hash_map(size_t bucket_hint) { reserve(bucket_hint); }
+  flat_hash_map(const flat_hash_map& other) : hasher(other.hasher), key_equal(other.key_equal)
+  {
+    reserve(other.size());
+    for (const value_type& v : other) insert(v);
+  }
+  flat_hash_map(flat_hash_map&& other) noexcept { swap(other); }
+  flat_hash_map& operator=(flat_hash_map other) noexcept
+  {
+    swap(other);
+    return *this;
+  }
+  ~flat_hash_map() { destroy(); }
+
+  void swap(flat_hash_map& other) noexcept
+  {
+    std::swap(ctrl, other.ctrl);
+    std::swap(slots, other.slots);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left, other.growth_left);
+    std::swap(hasher, other.hasher);
+    std::swap(key_equal, other.key_equal);
+  }
+
+  iterator begin()
+  {
+    iterator it(ctrl, slots, ctrl + capacity_);
+    it.skip_free();
+    return it;
+  }
+  iterator end() { return iterator(ctrl + capacity_, slots + capacity_, ctrl + capacity_); }
+  const_iterator begin() const { return const_cast<flat_hash_map*>(this)->begin(); }
+  const_iterator end() const { return const_cast<flat_hash_map*>(this)->end(); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+  double load_factor() const { return capacity_ ? double(size_) / capacity_ : 0.0; }
+
+  void clear()
+  {
+    if (!capacity_) return;
+    for (size_t i = 0; i < capacity_; i++)
+      if (ctrl[i] >= 0) slots[i].value.~value_type();
+    std::memset(ctrl, detail::EMPTY, capacity_);
+    size_ = 0;
+    growth_left = max_load(capacity_);
+  }
+
+  /* make room for n elements without a rehash */
+  void reserve(size_t n)
+  {
+    size_t cap = GROUP_WIDTH;
+    while (max_load(cap) < n) cap *= 2;
+    if (cap > capacity_) rehash(cap);
+  }
+
+  iterator find(const Key& key) { return find_hashed(key, hasher(key)); }
+  const_iterator find(const Key& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+  bool contains(const Key& key) const { return find(key) != end(); }
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+  template <typename K, typename = enable_if_transparent<K>>
+  iterator find(const K& key)
+  {
+    return find_hashed(key, hasher(key));
+  }
+  template <typename K, typename = enable_if_transparent<K>>
+  const_iterator find(const K& key) const
+  {
+    return const_cast<flat_hash_map*>(this)->find(key);
+  }
+  template <typename K, typename = enable_if_transparent<K>>
+  bool contains(const K& key) const
+  {
+    return find(key) != end();
+  }
+
+  /* batched lookup, software pipelined over the keys: key i+2D is hashed and its control
+   * group prefetched, key i+D has its h2 matched and the candidate slot prefetched, key i
+   * is resolved. The cache misses of 2D keys are in flight at the same time instead of
+   * being paid one after the other. out[i] is nullptr when keys[i] is not present. */
+  template <typename K = Key>
+  void find_batch(const K* keys, size_t n, value_type** out)
+  {
+    static_assert(std::is_same<K, Key>::value || detail::is_transparent<Hash, KeyEqual, K>::value,
+                  "find_batch with a foreign key type needs a transparent Hash and KeyEqual");
+    if (!capacity_) {
+      for (size_t i = 0; i < n; i++) out[i] = nullptr;
+      return;
+    }
+    constexpr size_t D = 8;
+    constexpr size_t RING = 4 * D;   /* power of two, larger than 2D */
+    size_t hashes[RING];
+    auto stage_hash = [&](size_t i) {
+      size_t h = hasher(keys[i]);
+      hashes[i & (RING - 1)] = h;
+      __builtin_prefetch(ctrl + (h1(h) & group_mask()) * GROUP_WIDTH);
+    };
+    auto stage_slot = [&](size_t i) {
+      size_t h = hashes[i & (RING - 1)];
+      size_t base = (h1(h) & group_mask()) * GROUP_WIDTH;
+      detail::BitMask m = Group(ctrl + base).match(h2(h));
+      if (m) __builtin_prefetch(slots + base + m.lowest());
+    };
+    for (size_t i = 0; i < n && i < 2 * D; i++) stage_hash(i);
+    for (size_t i = 0; i < n && i < D; i++) stage_slot(i);
+    for (size_t i = 0; i < n; i++) {
+      if (i + 2 * D < n) stage_hash(i + 2 * D);
+      if (i + D < n) stage_slot(i + D);
+      iterator it = find_hashed(keys[i], hashes[i & (RING - 1)]);
+      out[i] = it == end() ? nullptr : &*it;
+    }
+  }
+
+  std::pair<iterator, bool> insert(const value_type& v) { return try_emplace(v.first, v.second); }
+  /* v.first is const, so the key is copied and only the value moved */
+  std::pair<iterator, bool> insert(value_type&& v) { return try_emplace(v.first, std::move(v.second)); }
+
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+  {
+    size_t h = hasher(key);
+    iterator it = find_hashed(key, h);
+    if (it != end()) return {it, false};
+    size_t i = prepare_insert(h);
+    new (&slots[i].value) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+    return {iterator(ctrl + i, slots + i, ctrl + capacity_), true};
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args)
+  {
+    mutable_value_type v(std::forward<Args>(args)...);
+    return try_emplace(std::move(v.first), std::move(v.second));
+  }
+
+  Value& operator[](const Key& key) { return try_emplace(key).first->second; }
+  Value& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+  size_t erase(const Key& key)
+  {
+    iterator it = find(key);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+
+  void erase(iterator it)
+  {
+    size_t i = static_cast<size_t>(it.slot - slots);
+    slots[i].value.~value_type();
+    size_--;
+    /* tombstone-free erase when the group was never full */
+    size_t g = i & ~(GROUP_WIDTH - 1);
+    if (Group(ctrl + g).match_empty()) {
+      ctrl[i] = detail::EMPTY;
+      growth_left++;
+    } else {
+      ctrl[i] = detail::DELETED;
+    }
+  }
+
+private:
+  static size_t max_load(size_t cap) { return cap - cap / 8; }
+  static size_t h1(size_t h) { return h >> 7; }
+  static int8_t h2(size_t h) { return static_cast<int8_t>(h & 0x7F); }
+  size_t group_mask() const { return capacity_ / GROUP_WIDTH - 1; }
+
+  template <typename K>
+  iterator find_hashed(const K& key, size_t h)
+  {
+    if (!capacity_) return end();
+    detail::ProbeSeq seq(h1(h), group_mask());
+    for (;;) {
+      size_t base = seq.group() * GROUP_WIDTH;
+      Group g(ctrl + base);
+      for (detail::BitMask m = g.match(h2(h)); m; m.clear_lowest()) {
+        size_t i = base + m.lowest();
+        if (key_equal(slots[i].value.first, key)) return iterator(ctrl + i, slots + i, ctrl + capacity_);
+      }
+      if (g.match_empty()) return end();
+      seq.next();
+    }
+  }
+
+  /* first EMPTY or DELETED slot on the probe sequence of h */
+  size_t find_free(size_t h) const
+  {
+    detail::ProbeSeq seq(h1(h), group_mask());
+    for (;;) {
+      size_t base = seq.group() * GROUP_WIDTH;
+      detail::BitMask m = Group(ctrl + base).match_empty_or_deleted();
+      if (m) return base + m.lowest();
+      seq.next();
+    }
+  }
+
+  size_t prepare_insert(size_t h)
+  {
+    size_t i = capacity_ ? find_free(h) : 0;
+    if (!capacity_ || (growth_left == 0 && ctrl[i] == detail::EMPTY)) {
+      /* too many tombstones: rehash in place, otherwise grow */
+      rehash(capacity_ && size_ < max_load(capacity_) / 2 ? capacity_ : (capacity_ ? capacity_ * 2 : GROUP_WIDTH));
+      i = find_free(h);
+    }
+    if (ctrl[i] == detail::EMPTY) growth_left--;
+    ctrl[i] = h2(h);
+    size_++;
+    return i;
+  }
+
+  void rehash(size_t new_capacity)
+  {
+    int8_t* old_ctrl = ctrl;
+    slot_type* old_slots = slots;
+    size_t old_capacity = capacity_;
+
+    ctrl = static_cast<int8_t*>(::operator new(new_capacity, std::align_val_t(GROUP_WIDTH)));
+    slots = static_cast<slot_type*>(::operator new(new_capacity * sizeof(slot_type), SLOT_ALIGN));
+    std::memset(ctrl, detail::EMPTY, new_capacity);
+    capacity_ = new_capacity;
+    growth_left = max_load(new_capacity) - size_;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] < 0) continue;
+      size_t h = hasher(old_slots[i].value.first);
+      size_t j = find_free(h);
+      ctrl[j] = h2(h);
+      transfer(&slots[j], &old_slots[i]);
+    }
+    free_arrays(old_ctrl, old_slots);
+  }
+
+  /* move-construct dst from src and destroy src; the key is copied when it cannot be moved */
+  static void transfer(slot_type* dst, slot_type* src)
+  {
+    if constexpr (MUTABLE_KEYS)
+      new (&dst->mutable_value) mutable_value_type(std::move(src->mutable_value));
+    else
+      new (&dst->value) value_type(src->value.first, std::move(src->value.second));
+    src->value.~value_type();
+  }
+
+  void destroy()
+  {
+    if (!capacity_) return;
+    if (!std::is_trivially_destructible<value_type>::value)
+      for (size_t i = 0; i < capacity_; i++)
+        if (ctrl[i] >= 0) slots[i].value.~value_type();
+    free_arrays(ctrl, slots);
+    ctrl = nullptr;
+    slots = nullptr;
+    capacity_ = size_ = growth_left = 0;
+  }
+
+  static void free_arrays(int8_t* c, slot_type* s)
+  {
+    if (c) ::operator delete(c, std::align_val_t(GROUP_WIDTH));
+    if (s) ::operator delete(s, SLOT_ALIGN);
+  }
+
+  int8_t* ctrl = nullptr;
+  slot_type* slots = nullptr;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  size_t growth_left = 0;
+  Hash hasher;
+  KeyEqual key_equal;
+};
+
+}; // end namespace ds
+#endif // FLAT_HASH_MAP_H
@@ -0,0 +1,175 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file benchmark.cpp
+ * @discription producers/consumers benchmark of ds::spsc_queue, ds::mpmc_queue and a
+ *              std::mutex + std::queue baseline. Every item carries the time it was pushed,
+ *              consumers record how long it waited in the queue. Reports ops/sec and the
+ *              p50 / p99 / max queueing latency.
+ *              usage: queue_benchmark [producers] [consumers] [items per producer] [batch]
+ */
+
+#include "mpmc_queue.h"
+#include "spsc_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+uint64_t now_ns()
+{
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count());
+}
+
+/* baseline: the textbook queue, one lock around std::queue */
+template <typename T>
+class locked_queue
+{
+public:
+  explicit locked_queue(size_t capacity) : cap(capacity) {}
+  template <typename U>
+  bool try_push(U&& value)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (queue.size() >= cap) return false;
+    queue.push(std::forward<U>(value));
+    return true;
+  }
+  bool try_pop(T& out)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (queue.empty()) return false;
+    out = queue.front();
+    queue.pop();
+    return true;
+  }
+  template <typename It>
+  size_t push_n(It first, size_t n)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t k = 0;
+    for (; k < n && queue.size() < cap; k++, ++first) queue.push(*first);
+    return k;
+  }
+  template <typename It>
+  size_t pop_n(It out, size_t n)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t k = 0;
+    for (; k < n && !queue.empty(); k++, ++out) {
+      *out = queue.front();
+      queue.pop();
+    }
+    return k;
+  }
+
+private:
+  std::mutex mutex;
+  std::queue<T> queue;
+  size_t cap;
+};
+
+struct Report
+{
+  double ops_per_sec;
+  uint64_t p50, p99, max;
+};
+
+template <typename Queue>
+Report run(size_t producers, size_t consumers, size_t items, size_t batch)
+{
+  Queue queue(4096);
+  std::atomic<size_t> consumed{0};
+  std::atomic<bool> go{false};
+  const size_t total = producers * items;
+  std::vector<std::vector<uint64_t>> latencies(consumers);
+  std::vector<std::thread> threads;
+
+  for (size_t p = 0; p < producers; p++)
+    threads.emplace_back([&] {
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      std::vector<uint64_t> buf(batch);
+      for (size_t sent = 0; sent < items;) {
+        size_t n = std::min(batch, items - sent);
+        uint64_t t = now_ns();
+        std::fill(buf.begin(), buf.begin() + n, t);
+        size_t done = 0;
+        while (done < n) {
+          size_t k = batch == 1 ? queue.try_push(t) : queue.push_n(buf.begin() + done, n - done);
+          if (k == 0) std::this_thread::yield();
+          done += k;
+        }
+        sent += n;
+      }
+    });
+
+  for (size_t c = 0; c < consumers; c++)
+    threads.emplace_back([&, c] {
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      std::vector<uint64_t> buf(batch);
+      std::vector<uint64_t>& lat = latencies[c];
+      lat.reserve(total / consumers + batch);
+      while (consumed.load(std::memory_order_relaxed) < total) {
+        size_t k = batch == 1 ? queue.try_pop(buf[0]) : queue.pop_n(buf.begin(), batch);
+        if (k == 0) {
+          std::this_thread::yield();
+          continue;
+        }
+        uint64_t t = now_ns();
+        for (size_t i = 0; i < k; i++) lat.push_back(t - buf[i]);
+        consumed.fetch_add(k, std::memory_order_relaxed);
+      }
+    });
+
+  auto start = clock_type::now();
+  go.store(true, std::memory_order_release);
+  for (std::thread& t : threads) t.join();
+  double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  std::vector<uint64_t> all;
+  for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+  std::sort(all.begin(), all.end());
+  return {total / seconds, all[all.size() / 2], all[all.size() * 99 / 100], all.back()};
+}
+
+void print(const char* name, const Report& r)
+{
+  std::printf("%-22s %12.0f ops/s   p50 %8llu ns   p99 %10llu ns   max %10llu ns\n", name, r.ops_per_sec,
+              (unsigned long long)r.p50, (unsigned long long)r.p99, (unsigned long long)r.max);
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  size_t producers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4;
+  size_t consumers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+  size_t items = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000000;
+  size_t batch = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1;
+  if (!producers || !consumers || !items || !batch) {
+    std::fprintf(stderr, "usage: %s [producers] [consumers] [items per producer] [batch]\n", argv[0]);
+    return 1;
+  }
+
+  std::printf("1 producer / 1 consumer, %zu items, batch %zu\n", items, batch);
+  print("spsc_queue", run<ds::spsc_queue<uint64_t>>(1, 1, items, batch));
+  print("mpmc_queue", run<ds::mpmc_queue<uint64_t>>(1, 1, items, batch));
+  print("mutex + std::queue", run<locked_queue<uint64_t>>(1, 1, items, batch));
+
+  std::printf("%zu producers / %zu consumers, %zu items each, batch %zu\n", producers, consumers, items, batch);
+  print("mpmc_queue", run<ds::mpmc_queue<uint64_t>>(producers, consumers, items, batch));
+  print("mutex + std::queue", run<locked_queue<uint64_t>>(producers, consumers, items, batch));
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file example.cpp
+ * @discription this example shows how to pass work between threads with ds::spsc_queue
+ *              and ds::mpmc_queue, then checks the edge cases: batches of 0 items on an
+ *              empty, a partly filled and a full queue, and queues destroyed while they
+ *              still hold items of a type without a default constructor
+ */
+
+#include "mpmc_queue.h"
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/* no default constructor, counts the live objects */
+struct Tracked
+{
+  static int live;
+  explicit Tracked(int v) : value(v) { live++; }
+  Tracked(const Tracked& other) : value(other.value) { live++; }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() { live--; }
+  int value;
+};
+int Tracked::live = 0;
+
+/* push_n / pop_n of 0 items return 0 and leave fill items in the queue */
+template <typename Queue>
+bool zero_batches(size_t fill)
+{
+  Queue queue(8);
+  for (size_t i = 0; i < fill; i++) queue.try_push(int(i));
+  int items[1] = {0};
+  if (queue.push_n(items, 0) != 0 || queue.pop_n(items, 0) != 0) return false;
+  size_t left = 0;
+  for (int v; queue.try_pop(v);) left++;
+  return left == fill;
+}
+
+template <typename Queue>
+bool destroy_with_items()
+{
+  {
+    Queue queue(8);
+    Tracked items[5] = {Tracked(1), Tracked(2), Tracked(3), Tracked(4), Tracked(5)};
+    queue.push_n(items, 5);
+    queue.try_push(Tracked(6));
+    /* wrap around the end of the ring before it is destroyed */
+    Tracked out(0);
+    for (int i = 0; i < 4; i++) queue.try_pop(out);
+    queue.push_n(items, 5);
+  }
+  return Tracked::live == 0;
+}
+
+} // end namespace
+
+int main()
+{
+  /* one producer, one consumer */
+  ds::spsc_queue<int> ring(8);
+  std::thread producer([&] {
+    for (int i = 1; i <= 100; i++)
+      while (!ring.try_push(i)) std::this_thread::yield();
+  });
+  long sum = 0;
+  for (int received = 0; received < 100;) {
+    int v;
+    if (ring.try_pop(v)) {
+      sum += v;
+      received++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  std::cout << "spsc sum 1..100 = " << sum << "\n";
+
+  /* several producers and consumers, items moved in batches */
+  ds::mpmc_queue<int> queue(64);
+  std::vector<std::thread> threads;
+  std::atomic<long> total{0};
+  std::atomic<int> remaining{4 * 1000};
+  for (int p = 0; p < 4; p++)
+    threads.emplace_back([&] {
+      int items[10];
+      for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 10; i++) items[i] = round * 10 + i;
+        for (size_t done = 0; done < 10;) {
+          size_t n = queue.push_n(items + done, 10 - done);
+          if (n == 0) std::this_thread::yield();
+          done += n;
+        }
+      }
+    });
+  for (int c = 0; c < 2; c++)
+    threads.emplace_back([&] {
+      int items[16];
+      while (remaining.load() > 0) {
+        size_t n = queue.pop_n(items, 16);
+        if (n == 0) {
+          std::this_thread::yield();
+          continue;
+        }
+        for (size_t i = 0; i < n; i++) total += items[i];
+        remaining -= static_cast<int>(n);
+      }
+    });
+  for (std::thread& t : threads) t.join();
+  std::cout << "mpmc sum = " << total << " (expected " << 4L * 999 * 1000 / 2 << ")\n";
+
+  bool ok = sum == 5050 && total == 4L * 999 * 1000 / 2;
+  for (size_t fill : {0, 3, 8}) {
+    if (!zero_batches<ds::spsc_queue<int>>(fill) || !zero_batches<ds::mpmc_queue<int>>(fill)) {
+      std::cout << "FAILED: a batch of 0 items with " << fill << " of 8 slots filled\n";
+      ok = false;
+    }
+  }
+  if (!destroy_with_items<ds::spsc_queue<Tracked>>() || !destroy_with_items<ds::mpmc_queue<Tracked>>()) {
+    std::cout << "FAILED: " << Tracked::live << " items left alive after the queues were destroyed\n";
+    ok = false;
+  }
+  std::cout << (ok ? "edge cases ok" : "edge cases FAILED") << "\n";
+  return ok ? 0 : 1;
+}
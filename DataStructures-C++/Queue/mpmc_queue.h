@@ -0,0 +1,177 @@
+/*
+ * Bounded multi-producer / multi-consumer queue (Dmitry Vyukov's design)
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file mpmc_queue.h
+ *
+ * Every cell carries a sequence number next to its value:
+ *   seq == pos        the cell is free for the producer that claims position pos
+ *   seq == pos + 1    the cell holds the value of position pos, ready for a consumer
+ *   seq == pos + N    the consumer released it, free again for the next lap
+ * Producers and consumers claim positions with a CAS on enqueue_pos / dequeue_pos and then
+ * only touch their own cell, so there is no lock and no shared write besides the CAS.
+ * push_n / pop_n claim a run of consecutive cells with a single CAS.
+ */
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace ds
+{
+
+template <typename T>
+class mpmc_queue
+{
+public:
+  /* capacity is rounded up to a power of two */
+  explicit mpmc_queue(size_t capacity)
+  {
+    size_t cap = 2;
+    while (cap < capacity) cap *= 2;
+    mask = cap - 1;
+    cells = new Cell[cap];
+    for (size_t i = 0; i < cap; i++) cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+  mpmc_queue(const mpmc_queue&) = delete;
+  mpmc_queue& operator=(const mpmc_queue&) = delete;
+  /* no other thread may use the queue any more: every position in
+   * [dequeue_pos, enqueue_pos) holds a value */
+  ~mpmc_queue()
+  {
+    size_t end = enqueue_pos.load(std::memory_order_relaxed);
+    for (size_t pos = dequeue_pos.load(std::memory_order_relaxed); pos != end; pos++)
+      reinterpret_cast<T*>(cells[pos & mask].storage)->~T();
+    delete[] cells;
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+  template <typename U>
+  bool try_push(U&& value)
+  {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells[pos & mask];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          new (cell.storage) T(std::forward<U>(value));
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;   /* full */
+      } else {
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T& out)
+  {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = cells[pos & mask];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          take(cell, pos, out);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;   /* empty */
+      } else {
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /* pushes up to n items from first, returns how many were pushed */
+  template <typename It>
+  size_t push_n(It first, size_t n)
+  {
+    /* run_length() would be 0 on a queue with room, which is not "full" */
+    if (n == 0) return 0;
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t k = run_length(pos, n, 0);
+      if (k == 0) {
+        size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) < 0) return 0;
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (enqueue_pos.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+        for (size_t i = 0; i < k; i++, ++first) {
+          Cell& cell = cells[(pos + i) & mask];
+          new (cell.storage) T(*first);
+          cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return k;
+      }
+    }
+  }
+
+  /* pops up to n items into out, returns how many were popped */
+  template <typename It>
+  size_t pop_n(It out, size_t n)
+  {
+    if (n == 0) return 0;
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t k = run_length(pos, n, 1);
+      if (k == 0) {
+        size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) return 0;
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (dequeue_pos.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+        for (size_t i = 0; i < k; i++, ++out) take(cells[(pos + i) & mask], pos + i, *out);
+        return k;
+      }
+    }
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  /* number of consecutive cells from pos (at most n) whose seq is pos + i + offset */
+  size_t run_length(size_t pos, size_t n, size_t offset) const
+  {
+    if (n > capacity()) n = capacity();
+    size_t k = 0;
+    while (k < n && cells[(pos + k) & mask].seq.load(std::memory_order_acquire) == pos + k + offset) k++;
+    return k;
+  }
+
+  void take(Cell& cell, size_t pos, T& out)
+  {
+    T* value = reinterpret_cast<T*>(cell.storage);
+    out = std::move(*value);
+    value->~T();
+    cell.seq.store(pos + mask + 1, std::memory_order_release);
+  }
+
+  alignas(CACHE_LINE) std::atomic<size_t> enqueue_pos{0};
+  alignas(CACHE_LINE) std::atomic<size_t> dequeue_pos{0};
+  alignas(CACHE_LINE) Cell* cells;
+  size_t mask;
+};
+
+}; // end namespace ds
+#endif // MPMC_QUEUE_H
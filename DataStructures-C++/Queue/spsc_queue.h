@@ -0,0 +1,138 @@
+/*
+ * Bounded single-producer / single-consumer ring buffer
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file spsc_queue.h
+ *
+ *   [ tail | cached_head ]  producer cache line
+ *   [ head | cached_tail ]  consumer cache line
+ *   [ slot 0 | slot 1 | ... | slot N-1 ]
+ *
+ * The producer owns tail, the consumer owns head, each on its own cache line. Both also
+ * keep a private copy of the other side's index and only reload the shared one when the
+ * copy says the ring is full (producer) or empty (consumer), so in steady state a push or
+ * pop does not touch the other thread's cache line at all.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ds
+{
+
+constexpr size_t CACHE_LINE = 64;
+
+template <typename T>
+class spsc_queue
+{
+public:
+  /* capacity is rounded up to a power of two */
+  explicit spsc_queue(size_t capacity)
+  {
+    size_t cap = 2;
+    while (cap < capacity) cap *= 2;
+    mask = cap - 1;
+    slots = static_cast<T*>(::operator new(cap * sizeof(T), std::align_val_t(alignof(T) > CACHE_LINE ? alignof(T) : CACHE_LINE)));
+  }
+  spsc_queue(const spsc_queue&) = delete;
+  spsc_queue& operator=(const spsc_queue&) = delete;
+  ~spsc_queue()
+  {
+    size_t tail = producer.tail.load(std::memory_order_relaxed);
+    for (size_t h = consumer.head.load(std::memory_order_relaxed); h != tail; h++) slots[h & mask].~T();
+    ::operator delete(slots, std::align_val_t(alignof(T) > CACHE_LINE ? alignof(T) : CACHE_LINE));
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+  /* producer side */
+  template <typename U>
+  bool try_push(U&& value)
+  {
+    size_t t = producer.tail.load(std::memory_order_relaxed);
+    if (t - producer.cached_head > mask) {
+      producer.cached_head = consumer.head.load(std::memory_order_acquire);
+      if (t - producer.cached_head > mask) return false;
+    }
+    new (slots + (t & mask)) T(std::forward<U>(value));
+    producer.tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /* pushes up to n items from first, returns how many were pushed */
+  template <typename It>
+  size_t push_n(It first, size_t n)
+  {
+    size_t t = producer.tail.load(std::memory_order_relaxed);
+    size_t free_slots = capacity() - (t - producer.cached_head);
+    if (free_slots < n) {
+      producer.cached_head = consumer.head.load(std::memory_order_acquire);
+      free_slots = capacity() - (t - producer.cached_head);
+    }
+    if (n > free_slots) n = free_slots;
+    for (size_t i = 0; i < n; i++, ++first) new (slots + ((t + i) & mask)) T(*first);
+    producer.tail.store(t + n, std::memory_order_release);
+    return n;
+  }
+
+  /* consumer side */
+  bool try_pop(T& out)
+  {
+    size_t h = consumer.head.load(std::memory_order_relaxed);
+    if (h == consumer.cached_tail) {
+      consumer.cached_tail = producer.tail.load(std::memory_order_acquire);
+      if (h == consumer.cached_tail) return false;
+    }
+    T* slot = slots + (h & mask);
+    out = std::move(*slot);
+    slot->~T();
+    consumer.head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /* pops up to n items into out, returns how many were popped */
+  template <typename It>
+  size_t pop_n(It out, size_t n)
+  {
+    size_t h = consumer.head.load(std::memory_order_relaxed);
+    size_t ready = consumer.cached_tail - h;
+    if (ready < n) {
+      consumer.cached_tail = producer.tail.load(std::memory_order_acquire);
+      ready = consumer.cached_tail - h;
+    }
+    if (n > ready) n = ready;
+    for (size_t i = 0; i < n; i++, ++out) {
+      T* slot = slots + ((h + i) & mask);
+      *out = std::move(*slot);
+      slot->~T();
+    }
+    consumer.head.store(h + n, std::memory_order_release);
+    return n;
+  }
+
+private:
+  struct alignas(CACHE_LINE) Producer
+  {
+    std::atomic<size_t> tail{0};
+    size_t cached_head = 0;
+  };
+  struct alignas(CACHE_LINE) Consumer
+  {
+    std::atomic<size_t> head{0};
+    size_t cached_tail = 0;
+  };
+
+  Producer producer;
+  Consumer consumer;
+  alignas(CACHE_LINE) T* slots;
+  size_t mask;
+};
+
+}; // end namespace ds
+#endif // SPSC_QUEUE_H
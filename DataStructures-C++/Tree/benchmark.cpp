@@ -0,0 +1,107 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file benchmark.cpp
+ * @discription ordered lookups (lower_bound) on ds::btree_map, ds::eytzinger_set,
+ *              std::map and std::lower_bound over a sorted std::vector, with working sets
+ *              that fit in L1, in L3 and only in DRAM.
+ *              usage: tree_benchmark [dram_keys] (default 16M int64 keys)
+ */
+
+#include "btree_map.h"
+#include "eytzinger_set.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+template <typename F>
+double ns_per_query(const std::vector<int64_t>& queries, F&& lookup, int64_t& checksum)
+{
+  auto start = clock_type::now();
+  for (int64_t q : queries) checksum += lookup(q);
+  return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / queries.size();
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  size_t dram_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16 * 1024 * 1024;
+  const size_t QUERIES = 2000000;
+  const int64_t MISS = -1;
+  std::mt19937_64 rng(7);
+
+  struct Level
+  {
+    const char* name;
+    size_t keys;
+  };
+  /* 8 byte keys: 2K keys = 16 KB of keys, 256K keys = 2 MB */
+  Level levels[] = {{"L1", 2 * 1024}, {"L3", 256 * 1024}, {"DRAM", dram_keys}};
+
+  std::printf("%-5s %10s | %10s %10s %10s %10s   (ns per lower_bound)\n", "set", "keys", "btree", "eytzinger",
+              "std::map", "sorted vec");
+  for (const Level& level : levels) {
+    std::vector<int64_t> keys(level.keys);
+    for (int64_t& k : keys) k = static_cast<int64_t>(rng() >> 2);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<int64_t> queries(QUERIES);
+    for (int64_t& q : queries) q = static_cast<int64_t>(rng() >> 2);
+
+    ds::btree_map<int64_t, int64_t> btree;
+    std::vector<int64_t> shuffled(keys);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    for (int64_t k : shuffled) btree.insert(k, k);
+    ds::eytzinger_set<int64_t> eytzinger(keys);
+    std::map<int64_t, int64_t> map;
+    for (int64_t k : shuffled) map.emplace(k, k);
+    shuffled = std::vector<int64_t>();
+
+    int64_t sums[4] = {};
+    double t_btree = ns_per_query(queries, [&](int64_t q) {
+      auto it = btree.lower_bound(q);
+      return it == btree.end() ? MISS : it.key();
+    }, sums[0]);
+    double t_eytzinger = ns_per_query(queries, [&](int64_t q) {
+      const int64_t* p = eytzinger.lower_bound(q);
+      return p ? *p : MISS;
+    }, sums[1]);
+    double t_map = ns_per_query(queries, [&](int64_t q) {
+      auto it = map.lower_bound(q);
+      return it == map.end() ? MISS : it->first;
+    }, sums[2]);
+    double t_vec = ns_per_query(queries, [&](int64_t q) {
+      auto it = std::lower_bound(keys.begin(), keys.end(), q);
+      return it == keys.end() ? MISS : *it;
+    }, sums[3]);
+
+    if (sums[0] != sums[3] || sums[1] != sums[3] || sums[2] != sums[3]) {
+      std::fprintf(stderr, "results differ at %zu keys\n", keys.size());
+      return 1;
+    }
+    std::printf("%-5s %10zu | %10.1f %10.1f %10.1f %10.1f\n", level.name, keys.size(), t_btree, t_eytzinger, t_map,
+                t_vec);
+  }
+
+  /* range scan over the linked leaves */
+  ds::btree_map<int64_t, int64_t> btree;
+  for (int64_t k = 0; k < 1000000; k++) btree.insert(k, k);
+  int64_t sum = 0;
+  auto start = clock_type::now();
+  btree.scan(0, 1000000, [&](int64_t, int64_t v) { sum += v; });
+  double ms = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+  std::printf("btree scan of 1M keys: %.2f ms (sum %lld, height %zu)\n", ms, (long long)sum, btree.height());
+  return 0;
+}
@@ -0,0 +1,393 @@
+/*
+ * Cache-conscious B+-tree
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file btree_map.h
+ *
+ * A binary search tree pays one cache miss per level, and with one key per node it has
+ * log2(n) levels. A B+-tree keeps N keys per node, where N is picked so the key array is
+ * exactly two cache lines (16 x int64 or 32 x int32). Each node is then a couple of cache
+ * lines, and the tree has only log_N(n) levels.
+ *
+ *   inner node : [count | keys[N] | children[N+1]]    keys[i] = smallest key under children[i+1]
+ *   leaf node  : [count | keys[N] | values[N] | next] leaves are linked for range scans
+ *
+ * Unused key slots are filled with the largest key value, so the in-node search can always
+ * compare the whole key array: with AVX2 that is 4 (int64) or 8 (int32) keys per compare
+ * and a popcount of the mask gives the position directly, no branch per key. The AVX2
+ * compare is compiled with target("avx2") and picked at run time, so a portable build
+ * uses it too; built with -mavx2 (or -march=native) the check goes away and it inlines.
+ *
+ * Nodes come from a std::pmr::memory_resource (the default heap unless one is given), so
+ * the tree can be built in an ds::arena_resource or ds::pool_resource.
+ */
+
+#ifndef BTREE_MAP_H
+#define BTREE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BTREE_MAP_AVX2 1
+#define BTREE_MAP_AVX2_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define BTREE_MAP_AVX2 1
+#define BTREE_MAP_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace ds
+{
+
+namespace detail
+{
+
+#ifdef BTREE_MAP_AVX2
+inline bool has_avx2()
+{
+#ifdef __AVX2__
+  return true;
+#else
+  static const bool yes = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return yes;
+#endif
+}
+
+template <size_t N>
+BTREE_MAP_AVX2_TARGET inline size_t count_less_avx2(const int64_t* keys, int64_t key)
+{
+  __m256i k = _mm256_set1_epi64x(key);
+  size_t n = 0;
+  for (size_t i = 0; i < N; i += 4) {
+    __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i));
+    n += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, v))));
+  }
+  return n;
+}
+
+template <size_t N>
+BTREE_MAP_AVX2_TARGET inline size_t count_less_avx2(const int32_t* keys, int32_t key)
+{
+  __m256i k = _mm256_set1_epi32(key);
+  size_t n = 0;
+  for (size_t i = 0; i < N; i += 8) {
+    __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i));
+    n += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, v))));
+  }
+  return n;
+}
+#endif
+
+/* key types and node sizes the AVX2 compare handles */
+template <typename Key, size_t N>
+constexpr bool avx2_keys = (std::is_same<Key, int64_t>::value && N % 4 == 0) ||
+                           (std::is_same<Key, int32_t>::value && N % 8 == 0);
+
+/* number of keys[0..N) that are smaller than key (keys sorted, padded with max) */
+template <typename Key, size_t N>
+inline size_t count_less(const Key* keys, const Key& key)
+{
+#ifdef BTREE_MAP_AVX2
+  if constexpr (avx2_keys<Key, N>)
+    if (has_avx2()) return count_less_avx2<N>(keys, key);
+#endif
+  size_t n = 0;
+  for (size_t i = 0; i < N; i++) n += keys[i] < key;
+  return n;
+}
+
+/* number of keys[0..N) that are smaller than or equal to key */
+template <typename Key, size_t N>
+inline size_t count_less_equal(const Key* keys, const Key& key)
+{
+#ifdef BTREE_MAP_AVX2
+  if constexpr (avx2_keys<Key, N>)
+    if (has_avx2()) return key == std::numeric_limits<Key>::max() ? N : count_less_avx2<N>(keys, key + 1);
+#endif
+  size_t n = 0;
+  for (size_t i = 0; i < N; i++) n += !(key < keys[i]);
+  return n;
+}
+
+} // end namespace detail
+
+template <typename Key, typename Value>
+class btree_map
+{
+  static_assert(std::numeric_limits<Key>::is_specialized, "btree_map pads nodes with numeric_limits<Key>::max()");
+
+public:
+  /* keys per node: two cache lines of keys */
+  static constexpr size_t N = 128 / sizeof(Key) < 4 ? 4 : 128 / sizeof(Key);
+
+private:
+  struct Node
+  {
+    bool leaf;
+    uint16_t count;
+  };
+  struct alignas(64) Inner : Node
+  {
+    alignas(32) Key keys[N];
+    Node* children[N + 1];
+  };
+  struct alignas(64) Leaf : Node
+  {
+    alignas(32) Key keys[N];
+    Value values[N];
+    Leaf* next;
+  };
+
+public:
+  class const_iterator
+  {
+  public:
+    const_iterator() = default;
+    const Key& key() const { return leaf->keys[index]; }
+    const Value& value() const { return leaf->values[index]; }
+    const_iterator& operator++()
+    {
+      if (++index == leaf->count) {
+        leaf = leaf->next;
+        index = 0;
+      }
+      return *this;
+    }
+    friend bool operator==(const const_iterator& a, const const_iterator& b)
+    {
+      return a.leaf == b.leaf && a.index == b.index;
+    }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) { return !(a == b); }
+
+  private:
+    friend class btree_map;
+    const_iterator(const Leaf* l, size_t i) : leaf(l), index(i)
+    {
+      if (leaf && index == leaf->count) {
+        leaf = leaf->next;
+        index = 0;
+      }
+    }
+    const Leaf* leaf = nullptr;
+    size_t index = 0;
+  };
+
+  explicit btree_map(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : resource(resource) {}
+  btree_map(const btree_map&) = delete;
+  btree_map& operator=(const btree_map&) = delete;
+  btree_map(btree_map&& other) noexcept
+      : resource(other.resource), root(std::exchange(other.root, nullptr)),
+        first_leaf(std::exchange(other.first_leaf, nullptr)), size_(std::exchange(other.size_, 0)),
+        height_(std::exchange(other.height_, 0))
+  {
+  }
+  ~btree_map() { destroy(root); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t height() const { return height_; }
+
+  const_iterator begin() const { return const_iterator(first_leaf, 0); }
+  const_iterator end() const { return const_iterator(); }
+
+  /* first element whose key is not less than key */
+  const_iterator lower_bound(const Key& key) const
+  {
+    if (!root) return end();
+    const Leaf* leaf = find_leaf(key);
+    size_t i = detail::count_less<Key, N>(leaf->keys, key);
+    return const_iterator(leaf, i < leaf->count ? i : leaf->count);
+  }
+
+  const Value* find(const Key& key) const
+  {
+    if (!root) return nullptr;
+    const Leaf* leaf = find_leaf(key);
+    size_t i = detail::count_less<Key, N>(leaf->keys, key);
+    return i < leaf->count && leaf->keys[i] == key ? &leaf->values[i] : nullptr;
+  }
+  bool contains(const Key& key) const { return find(key) != nullptr; }
+
+  /* calls f(key, value) for every key in [lo, hi), walking the linked leaves */
+  template <typename F>
+  void scan(const Key& lo, const Key& hi, F&& f) const
+  {
+    for (const_iterator it = lower_bound(lo); it != end() && it.key() < hi; ++it) f(it.key(), it.value());
+  }
+
+  /* returns false (and leaves the value alone) when the key is already present */
+  bool insert(const Key& key, const Value& value)
+  {
+    if (!root) {
+      Leaf* leaf = new_leaf();
+      root = first_leaf = leaf;
+      height_ = 1;
+    }
+    Split split;
+    bool inserted = insert(root, key, value, split);
+    if (split.node) {
+      Inner* top = new_inner();
+      top->keys[0] = split.key;
+      top->children[0] = root;
+      top->children[1] = split.node;
+      top->count = 1;
+      root = top;
+      height_++;
+    }
+    size_ += inserted;
+    return inserted;
+  }
+
+private:
+  struct Split
+  {
+    Key key{};
+    Node* node = nullptr;
+  };
+
+  Leaf* new_leaf()
+  {
+    Leaf* l = new (resource->allocate(sizeof(Leaf), alignof(Leaf))) Leaf;
+    l->leaf = true;
+    l->count = 0;
+    l->next = nullptr;
+    for (size_t i = 0; i < N; i++) l->keys[i] = std::numeric_limits<Key>::max();
+    return l;
+  }
+  Inner* new_inner()
+  {
+    Inner* n = new (resource->allocate(sizeof(Inner), alignof(Inner))) Inner;
+    n->leaf = false;
+    n->count = 0;
+    for (size_t i = 0; i < N; i++) n->keys[i] = std::numeric_limits<Key>::max();
+    return n;
+  }
+
+  const Leaf* find_leaf(const Key& key) const
+  {
+    const Node* node = root;
+    while (!node->leaf) {
+      const Inner* in = static_cast<const Inner*>(node);
+      size_t i = detail::count_less_equal<Key, N>(in->keys, key);
+      node = in->children[i < in->count ? i : in->count];
+      __builtin_prefetch(node);
+      __builtin_prefetch(reinterpret_cast<const char*>(node) + 64);
+    }
+    return static_cast<const Leaf*>(node);
+  }
+
+  bool insert(Node* node, const Key& key, const Value& value, Split& split)
+  {
+    if (node->leaf) {
+      Leaf* leaf = static_cast<Leaf*>(node);
+      size_t i = detail::count_less<Key, N>(leaf->keys, key);
+      if (i > leaf->count) i = leaf->count;
+      if (i < leaf->count && leaf->keys[i] == key) return false;
+      if (leaf->count == N) {
+        /* split in halves, the new key goes to the half it belongs to */
+        Leaf* right = new_leaf();
+        size_t half = N / 2;
+        for (size_t j = half; j < N; j++) {
+          right->keys[j - half] = leaf->keys[j];
+          right->values[j - half] = leaf->values[j];
+          leaf->keys[j] = std::numeric_limits<Key>::max();
+        }
+        right->count = static_cast<uint16_t>(N - half);
+        leaf->count = static_cast<uint16_t>(half);
+        right->next = leaf->next;
+        leaf->next = right;
+        if (i > half) {
+          leaf_insert_at(right, i - half, key, value);
+        } else {
+          leaf_insert_at(leaf, i, key, value);
+        }
+        split.key = right->keys[0];
+        split.node = right;
+        return true;
+      }
+      leaf_insert_at(leaf, i, key, value);
+      return true;
+    }
+
+    Inner* in = static_cast<Inner*>(node);
+    size_t i = detail::count_less_equal<Key, N>(in->keys, key);
+    if (i > in->count) i = in->count;
+    Split child;
+    bool inserted = insert(in->children[i], key, value, child);
+    if (!child.node) return inserted;
+
+    if (in->count < N) {
+      inner_insert_at(in, i, child.key, child.node);
+      return inserted;
+    }
+    /* full inner node: the middle key moves up, it is not kept in either half */
+    Key keys[N + 1];
+    Node* children[N + 2];
+    for (size_t j = 0, k = 0; j <= N; j++) keys[j] = j == i ? child.key : in->keys[k++];
+    for (size_t j = 0, k = 0; j <= N + 1; j++) children[j] = j == i + 1 ? child.node : in->children[k++];
+    size_t mid = (N + 1) / 2;
+    Inner* right = new_inner();
+    for (size_t j = 0; j < N; j++) in->keys[j] = std::numeric_limits<Key>::max();
+    for (size_t j = 0; j < mid; j++) in->keys[j] = keys[j];
+    for (size_t j = 0; j <= mid; j++) in->children[j] = children[j];
+    in->count = static_cast<uint16_t>(mid);
+    for (size_t j = mid + 1; j <= N; j++) right->keys[j - mid - 1] = keys[j];
+    for (size_t j = mid + 1; j <= N + 1; j++) right->children[j - mid - 1] = children[j];
+    right->count = static_cast<uint16_t>(N - mid);
+    split.key = keys[mid];
+    split.node = right;
+    return inserted;
+  }
+
+  static void leaf_insert_at(Leaf* leaf, size_t i, const Key& key, const Value& value)
+  {
+    for (size_t j = leaf->count; j > i; j--) {
+      leaf->keys[j] = leaf->keys[j - 1];
+      leaf->values[j] = leaf->values[j - 1];
+    }
+    leaf->keys[i] = key;
+    leaf->values[i] = value;
+    leaf->count++;
+  }
+
+  static void inner_insert_at(Inner* in, size_t i, const Key& key, Node* child)
+  {
+    for (size_t j = in->count; j > i; j--) {
+      in->keys[j] = in->keys[j - 1];
+      in->children[j + 1] = in->children[j];
+    }
+    in->keys[i] = key;
+    in->children[i + 1] = child;
+    in->count++;
+  }
+
+  void destroy(Node* node)
+  {
+    if (!node) return;
+    if (node->leaf) {
+      static_cast<Leaf*>(node)->~Leaf();
+      resource->deallocate(node, sizeof(Leaf), alignof(Leaf));
+      return;
+    }
+    Inner* in = static_cast<Inner*>(node);
+    for (size_t i = 0; i <= in->count; i++) destroy(in->children[i]);
+    in->~Inner();
+    resource->deallocate(in, sizeof(Inner), alignof(Inner));
+  }
+
+  std::pmr::memory_resource* resource;
+  Node* root = nullptr;
+  Leaf* first_leaf = nullptr;
+  size_t size_ = 0;
+  size_t height_ = 0;
+};
+
+}; // end namespace ds
+#endif // BTREE_MAP_H
@@ -0,0 +1,32 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file example.cpp
+ * @discription this example shows how to use ds::btree_map and ds::eytzinger_set
+ */
+
+#include "btree_map.h"
+#include "eytzinger_set.h"
+
+#include <iostream>
+#include <vector>
+
+int main()
+{
+  ds::btree_map<int64_t, int64_t> tree;
+  for (int64_t k = 100; k > 0; k--) tree.insert(k * 10, k * k);
+
+  if (const int64_t* v = tree.find(420)) std::cout << "420 -> " << *v << "\n";
+  std::cout << "contains 425: " << tree.contains(425) << "\n";
+  std::cout << "lower_bound(425) = " << tree.lower_bound(425).key() << "\n";
+
+  std::cout << "keys in [200, 260):";
+  tree.scan(200, 260, [](int64_t key, int64_t) { std::cout << " " << key; });
+  std::cout << "\nsize " << tree.size() << ", height " << tree.height() << "\n";
+
+  ds::eytzinger_set<int32_t> primes(std::vector<int32_t>{2, 3, 5, 7, 11, 13, 17, 19, 23, 29});
+  std::cout << "first prime >= 14: " << *primes.lower_bound(14) << "\n";
+  std::cout << "contains 21: " << primes.contains(21) << ", contains 23: " << primes.contains(23) << "\n";
+  std::cout << "lower_bound(30) found: " << (primes.lower_bound(30) != nullptr) << "\n";
+  return 0;
+}
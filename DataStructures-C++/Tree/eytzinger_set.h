@@ -0,0 +1,87 @@
+/*
+ * Read-only sorted set in Eytzinger (BFS) layout
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file eytzinger_set.h
+ *
+ * The sorted keys are stored the way an implicit binary search tree would be stored in a
+ * heap: the root at index 1, the children of k at 2k and 2k+1.
+ *
+ *   sorted    : 1 2 3 4 5 6 7
+ *   eytzinger : _ 4 2 6 1 3 5 7
+ *
+ * A binary search on a sorted array touches positions all over the array. Here the first
+ * levels of every search are the same few cache lines at the front of the array, and the
+ * descendants of k four levels down (three for 64-bit keys) fill exactly one cache line.
+ * The search prefetches that line while it works on the current level, and it picks the
+ * next index with arithmetic (k = 2k + (b[k] < x)) instead of a branch.
+ */
+
+#ifndef EYTZINGER_SET_H
+#define EYTZINGER_SET_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace ds
+{
+
+template <typename T>
+class eytzinger_set
+{
+public:
+  /* keys must be sorted and unique */
+  explicit eytzinger_set(const std::vector<T>& sorted) : n(sorted.size())
+  {
+    data = static_cast<T*>(::operator new((n + 1) * sizeof(T), std::align_val_t(64)));
+    size_t i = 0;
+    build(sorted, i, 1);
+  }
+  eytzinger_set(const eytzinger_set&) = delete;
+  eytzinger_set& operator=(const eytzinger_set&) = delete;
+  ~eytzinger_set()
+  {
+    for (size_t k = 1; k <= n; k++) data[k].~T();
+    ::operator delete(data, std::align_val_t(64));
+  }
+
+  size_t size() const { return n; }
+
+  /* smallest key not less than x, nullptr when every key is smaller */
+  const T* lower_bound(const T& x) const
+  {
+    constexpr size_t PER_LINE = 64 / sizeof(T) ? 64 / sizeof(T) : 1;
+    size_t k = 1;
+    while (k <= n) {
+      __builtin_prefetch(data + k * PER_LINE);
+      k = 2 * k + (data[k] < x);
+    }
+    /* the path went right after the answer every time: drop those trailing 1 bits and
+     * the one 0 bit before them to get back to the last left turn */
+    k >>= __builtin_ffsll(static_cast<long long>(~k));
+    return k ? data + k : nullptr;
+  }
+
+  bool contains(const T& x) const
+  {
+    const T* p = lower_bound(x);
+    return p && !(x < *p);
+  }
+
+private:
+  /* in-order walk of the implicit tree hands out the sorted keys */
+  void build(const std::vector<T>& sorted, size_t& i, size_t k)
+  {
+    if (k > n) return;
+    build(sorted, i, 2 * k);
+    new (data + k) T(sorted[i++]);
+    build(sorted, i, 2 * k + 1);
+  }
+
+  size_t n;
+  T* data;
+};
+
+}; // end namespace ds
+#endif // EYTZINGER_SET_H
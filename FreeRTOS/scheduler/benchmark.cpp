@@ -0,0 +1,406 @@
+/*
+ * this file is a part of FreeRTOS project, https://github.com/over-infinity/-Tutorials/FreeRTOS
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* benchmark.cpp */
+
+/***********************************************************************************
+ Context switch latency and scheduling throughput against std::thread + condition variables.
+
+   ping-pong  two tasks hand the CPU to each other: Yield() between tasks of the same
+              priority, NotifyGive() / NotifyTake() between two tasks, and two std::threads
+              with a mutex, a condition variable and a turn flag
+   create     TaskCreate() of [tasks] tasks
+   yield      all tasks ready, every one yields 10 times (round robin in one ready list),
+              then the same spread over the 32 priorities: a priority must be finished
+              before any task of a lower one runs
+   ring       a token goes around a ring of all tasks 10 times (NotifyTake() the token,
+              NotifyGive() it to the next); the thread ring has one condition variable per
+              thread and as many threads as can be created up to [max threads]
+   timers     every task sleeps 5 times for a random 1 ns .. [tasks] * 10 us (1 s for 100k
+              tasks, so the scheduler is not overloaded): all of them in the pairing heap
+              at once; tasks must wake up in deadline order and never early
+   long       Delay() and NotifyTake() with timeouts close to MAX_DELAY must block, not wrap
+              around the clock and return at once
+
+ The program exits with 1 when a count or an order check fails.
+
+ usage: scheduler_benchmark [tasks] [ping-pong rounds] [max threads] (default 100000, 1000000, 10000)
+************************************************************************************/
+
+#include "scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+static double NsSince(clock_type::time_point start){
+   return std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+}
+
+static bool failed = false;
+
+static void Check(bool ok, const char* what){
+   if(!ok){
+      std::printf("  FAILED: %s\n", what);
+      failed = true;
+   }
+}
+
+/***********************************************************************************
+ ping-pong
+************************************************************************************/
+struct PingPong{
+   Scheduler* scheduler;
+   Scheduler::TaskHandle peer[2];
+   size_t rounds;
+   size_t done[2];
+};
+
+static PingPong pp;
+
+static void YieldTask(void* arg){
+   size_t id = reinterpret_cast<uintptr_t>(arg);
+   for(size_t i = 0; i < pp.rounds; i++){
+      pp.done[id]++;
+      pp.scheduler->Yield();
+   }
+}
+
+static void NotifyTask(void* arg){
+   size_t id = reinterpret_cast<uintptr_t>(arg);
+   for(size_t i = 0; i < pp.rounds; i++){
+      if(id == 0){
+         pp.scheduler->NotifyGive(pp.peer[1]);
+         pp.scheduler->NotifyTake(true);
+      }else{
+         pp.scheduler->NotifyTake(true);
+         pp.scheduler->NotifyGive(pp.peer[0]);
+      }
+      pp.done[id]++;
+   }
+}
+
+static double SchedulerPingPong(Scheduler::TaskFunction code, size_t rounds){
+   Scheduler scheduler;
+   pp = PingPong{&scheduler, {nullptr, nullptr}, rounds, {0, 0}};
+   pp.peer[0] = scheduler.TaskCreate(code, reinterpret_cast<void*>(uintptr_t(0)), 1);
+   pp.peer[1] = scheduler.TaskCreate(code, reinterpret_cast<void*>(uintptr_t(1)), 1);
+   auto start = clock_type::now();
+   scheduler.Start();
+   double ns = NsSince(start);
+   Check(pp.done[0] == rounds && pp.done[1] == rounds, "ping-pong rounds");
+   return ns / scheduler.GetStats().context_switches;
+}
+
+static double ThreadPingPong(size_t rounds){
+   std::mutex mutex;
+   std::condition_variable cv;
+   int turn = 0;
+   size_t done[2] = {0, 0};
+   auto player = [&](int id){
+      for(size_t i = 0; i < rounds; i++){
+         std::unique_lock<std::mutex> lock(mutex);
+         cv.wait(lock, [&]{ return turn == id; });
+         turn = 1 - id;
+         done[id]++;
+         cv.notify_one();
+      }
+   };
+   auto start = clock_type::now();
+   std::thread a(player, 0), b(player, 1);
+   a.join();
+   b.join();
+   double ns = NsSince(start);
+   Check(done[0] == rounds && done[1] == rounds, "thread ping-pong rounds");
+   return ns / (2 * rounds);
+}
+
+/***********************************************************************************
+ many tasks: yield, ring, timers
+************************************************************************************/
+static const size_t YIELDS = 10;
+static const size_t LAPS = 10;
+static const size_t SLEEPS = 5;
+
+struct Many{
+   Scheduler* scheduler;
+   std::vector<Scheduler::TaskHandle> handles;
+   std::vector<size_t> count;
+   std::vector<unsigned> finished_priority;   /* priority of every task, in the order they finished */
+   uint64_t sleep_range;
+   uint64_t last_deadline;
+   bool order_ok;
+   uint64_t late_ns;
+   std::mt19937_64 rng;
+};
+
+static Many many;
+
+static void ManyYieldTask(void* arg){
+   size_t id = reinterpret_cast<uintptr_t>(arg);
+   for(size_t i = 0; i < YIELDS; i++){
+      many.count[id]++;
+      many.scheduler->Yield();
+   }
+   many.finished_priority.push_back(many.scheduler->GetPriority(many.scheduler->CurrentTask()));
+}
+
+static void RingTask(void* arg){
+   size_t id = reinterpret_cast<uintptr_t>(arg);
+   Scheduler::TaskHandle next = many.handles[(id + 1) % many.handles.size()];
+   for(size_t lap = 0; lap < LAPS; lap++){
+      /* task 0 starts each lap by passing the token on */
+      if(id == 0) many.scheduler->NotifyGive(next);
+      many.scheduler->NotifyTake(true);
+      many.count[id]++;
+      if(id != 0) many.scheduler->NotifyGive(next);
+   }
+}
+
+static void TimerTask(void* arg){
+   size_t id = reinterpret_cast<uintptr_t>(arg);
+   for(size_t i = 0; i < SLEEPS; i++){
+      uint64_t ns = 1 + many.rng() % many.sleep_range;
+      uint64_t deadline = Scheduler::Now() + ns;
+      many.scheduler->DelayUntil(deadline);
+      uint64_t now = Scheduler::Now();
+      if(now < deadline || deadline < many.last_deadline) many.order_ok = false;
+      many.last_deadline = deadline;
+      many.late_ns += now - deadline;
+      many.count[id]++;
+   }
+}
+
+/* creates n tasks of code, priority of task i from priority(i); returns ns per create */
+template <typename Priority>
+static double CreateTasks(Scheduler& scheduler, size_t n, Scheduler::TaskFunction code, Priority priority){
+   many.scheduler = &scheduler;
+   many.handles.assign(n, nullptr);
+   many.count.assign(n, 0);
+   many.finished_priority.clear();
+   many.finished_priority.reserve(n);
+   many.sleep_range = n * 10000;
+   many.last_deadline = 0;
+   many.order_ok = true;
+   many.late_ns = 0;
+   many.rng.seed(7);
+   auto start = clock_type::now();
+   for(size_t i = 0; i < n; i++)
+      many.handles[i] = scheduler.TaskCreate(code, reinterpret_cast<void*>(uintptr_t(i)), priority(i));
+   return NsSince(start) / n;
+}
+
+static bool AllCounts(size_t expected){
+   for(size_t c : many.count)
+      if(c != expected) return false;
+   return true;
+}
+
+static void RunMany(size_t n){
+   std::printf("\n%zu tasks, %zu byte stacks\n", n, Scheduler::DEFAULT_STACK_SIZE);
+   {
+      Scheduler scheduler;
+      double create = CreateTasks(scheduler, n, ManyYieldTask, [](size_t){ return 1u; });
+      std::printf("  %-34s %9.1f ns/task\n", "create", create);
+      auto start = clock_type::now();
+      scheduler.Start();
+      double ns = NsSince(start);
+      uint64_t switches = scheduler.GetStats().context_switches;
+      std::printf("  %-34s %9.1f ns/switch  %7.2f M switches/s\n", "yield, one priority", ns / switches, switches / ns * 1e3);
+      Check(AllCounts(YIELDS) && scheduler.NumberOfTasks() == 0, "yield counts");
+   }
+   {
+      Scheduler scheduler;
+      CreateTasks(scheduler, n, ManyYieldTask, [](size_t i){ return unsigned(i % Scheduler::MAX_PRIORITIES); });
+      auto start = clock_type::now();
+      scheduler.Start();
+      double ns = NsSince(start);
+      uint64_t switches = scheduler.GetStats().context_switches;
+      std::printf("  %-34s %9.1f ns/switch  %7.2f M switches/s\n", "yield, 32 priorities", ns / switches, switches / ns * 1e3);
+      bool ordered = many.finished_priority.size() == n;
+      for(size_t i = 1; ordered && i < n; i++) ordered = many.finished_priority[i] <= many.finished_priority[i - 1];
+      Check(AllCounts(YIELDS) && ordered, "priority order");
+   }
+   {
+      Scheduler scheduler;
+      CreateTasks(scheduler, n, RingTask, [](size_t){ return 1u; });
+      auto start = clock_type::now();
+      scheduler.Start();
+      double ns = NsSince(start);
+      std::printf("  %-34s %9.1f ns/handoff  (%zu handoffs, %llu switches)\n", "token ring", ns / (n * LAPS), n * LAPS,
+                  (unsigned long long)scheduler.GetStats().context_switches);
+      Check(AllCounts(LAPS) && scheduler.NumberOfTasks() == 0, "ring counts");
+   }
+   {
+      Scheduler scheduler;
+      CreateTasks(scheduler, n, TimerTask, [](size_t){ return 1u; });
+      auto start = clock_type::now();
+      scheduler.Start();
+      double ns = NsSince(start);
+      const Scheduler::Stats& stats = scheduler.GetStats();
+      std::printf("  %-34s %9.1f ns/wakeup busy  (%llu wakeups in %.1f ms, %.1f ms idle, %.1f us late on average)\n",
+                  "timers", (ns - stats.idle_ns) / stats.timer_wakeups, (unsigned long long)stats.timer_wakeups, ns / 1e6,
+                  stats.idle_ns / 1e6, many.late_ns / 1e3 / (n * SLEEPS));
+      Check(AllCounts(SLEEPS) && many.order_ok && stats.timer_wakeups == n * SLEEPS, "timer order");
+   }
+}
+
+/* the token ring with one std::thread and one condition variable per member. Member 0 is
+ * started when all others wait for the token, thread start up is not timed */
+struct LongTimeouts{
+   Scheduler* scheduler;
+   Scheduler::TaskHandle taker, sleeper;
+   uint32_t taken;
+   uint64_t taken_after;
+   bool woke;
+};
+static LongTimeouts lt;
+
+static void LongTakeTask(void*){
+   uint64_t start = Scheduler::Now();
+   lt.taken = lt.scheduler->NotifyTake(true, Scheduler::MAX_DELAY - 1);
+   lt.taken_after = Scheduler::Now() - start;
+}
+
+static void LongDelayTask(void*){
+   lt.scheduler->Delay(Scheduler::MAX_DELAY - 1);
+   lt.woke = true;
+}
+
+/* lower priority: runs once both long waits have started, ends them 1 ms later */
+static void LongWakeTask(void*){
+   lt.scheduler->Delay(1000000);
+   lt.scheduler->NotifyGive(lt.taker);
+   lt.scheduler->Suspend(lt.sleeper);
+}
+
+static void LongTimeoutCheck(){
+   Scheduler scheduler;
+   lt = LongTimeouts{&scheduler, nullptr, nullptr, 0, 0, false};
+   lt.taker = scheduler.TaskCreate(LongTakeTask, nullptr, 2);
+   lt.sleeper = scheduler.TaskCreate(LongDelayTask, nullptr, 2);
+   scheduler.TaskCreate(LongWakeTask, nullptr, 1);
+   scheduler.Start();
+   std::printf("long timeouts: NotifyTake(MAX_DELAY - 1) returned %u after %.1f ms\n", lt.taken, lt.taken_after / 1e6);
+   Check(lt.taken == 1 && lt.taken_after >= 1000000, "NotifyTake() with a long timeout");
+   Check(!lt.woke && scheduler.GetState(lt.sleeper) == Scheduler::eSuspended, "Delay() with a long delay");
+}
+
+static void ThreadRing(size_t n, size_t max_threads){
+   n = n < max_threads ? n : max_threads;
+   struct Member{
+      std::mutex mutex;
+      std::condition_variable cv;
+      bool token = false;
+      size_t count = 0;
+   };
+   std::vector<std::unique_ptr<Member>> ring;
+   for(size_t i = 0; i < n; i++) ring.emplace_back(new Member());
+   std::atomic<size_t> waiting(0);
+   std::atomic<bool> abort(false);
+   auto give = [](Member& m){
+      { std::lock_guard<std::mutex> lock(m.mutex); m.token = true; }
+      m.cv.notify_one();
+   };
+   auto pass = [&](size_t id){
+      Member& me = *ring[id];
+      Member& next = *ring[(id + 1) % ring.size()];
+      for(size_t lap = 0; lap < LAPS; lap++){
+         if(id == 0) give(next);
+         {
+            std::unique_lock<std::mutex> lock(me.mutex);
+            if(lap == 0) waiting++;
+            me.cv.wait(lock, [&]{ return me.token || abort; });
+            if(abort) return;
+            me.token = false;
+         }
+         me.count++;
+         if(id != 0) give(next);
+      }
+   };
+
+   std::vector<std::thread> threads;
+   try{
+      for(size_t i = 1; i < n; i++) threads.emplace_back(pass, i);
+   }catch(const std::system_error& e){
+      std::printf("  std::thread ring: only %zu of %zu threads could be created (%s)\n", threads.size(), n, e.what());
+      abort = true;
+      for(auto& m : ring) give(*m);
+      for(std::thread& t : threads) t.join();
+      failed = true;
+      return;
+   }
+   while(waiting < n - 1) std::this_thread::yield();
+   auto start = clock_type::now();
+   threads.emplace_back(pass, 0);
+   for(std::thread& t : threads) t.join();
+   double ns = NsSince(start);
+   bool ok = true;
+   for(auto& m : ring) ok = ok && m->count == LAPS;
+   std::printf("  %-34s %9.1f ns/handoff  (%zu threads, %zu handoffs)\n", "std::thread + condvar ring",
+               ns / (n * LAPS), n, n * LAPS);
+   Check(ok, "thread ring counts");
+}
+
+int main(int argc, char* argv[]){
+   size_t tasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+   size_t rounds = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+   size_t max_threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000;
+   if(tasks < 2) tasks = 2;
+
+#ifdef SCHEDULER_UCONTEXT
+   std::printf("context switch: ucontext (swapcontext)\n");
+#else
+   std::printf("context switch: port_switch (x86-64 assembler)\n");
+#endif
+   try{
+      std::printf("ping-pong, %zu rounds\n", rounds);
+      std::printf("  %-34s %9.1f ns/switch\n", "Yield(), same priority", SchedulerPingPong(YieldTask, rounds));
+      std::printf("  %-34s %9.1f ns/switch\n", "NotifyGive() / NotifyTake()", SchedulerPingPong(NotifyTask, rounds));
+      size_t thread_rounds = rounds / 10 ? rounds / 10 : 1;
+      std::printf("  %-34s %9.1f ns/handoff  (%zu rounds)\n", "std::thread + condvar", ThreadPingPong(thread_rounds),
+                  thread_rounds);
+
+      LongTimeoutCheck();
+      RunMany(tasks);
+      ThreadRing(tasks, max_threads);
+   }catch(const std::exception& e){
+      std::printf("%s\n", e.what());
+      return 1;
+   }
+   return failed ? 1 : 0;
+}
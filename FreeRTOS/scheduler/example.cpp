@@ -0,0 +1,102 @@
+/*
+ * this file is a part of FreeRTOS project, https://github.com/over-infinity/-Tutorials/FreeRTOS
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* example.cpp */
+
+/***********************************************************************************
+ Three tasks on one thread:
+   - sensor (priority 2) wakes up every 10 ms and notifies the worker
+   - worker (priority 3) waits for the notifications, after 3 of them it suspends the
+     logger and after 5 it resumes it and returns
+   - logger (priority 1) counts up to 1000, delaying 100 us between counts
+ The higher priority task always runs first: a notification switches to the worker at
+ once, the logger only runs while both others wait.
+************************************************************************************/
+
+#include "scheduler.h"
+
+#include <cstdio>
+
+static Scheduler scheduler;
+static Scheduler::TaskHandle worker, logger;
+static uint64_t t0;
+static long idle_counts = 0;
+
+static double Ms(){
+   return (Scheduler::Now() - t0) / 1e6;
+}
+
+static void Sensor(void*){
+   for(int i = 0; i < 5; i++){
+      scheduler.Delay(10 * 1000000);
+      std::printf("%6.1f ms  sensor: sample %d\n", Ms(), i);
+      scheduler.NotifyGive(worker);
+      std::printf("%6.1f ms  sensor: back after the worker\n", Ms());
+   }
+}
+
+static void Worker(void*){
+   for(int n = 1; n <= 5; n++){
+      scheduler.NotifyTake(true);
+      std::printf("%6.1f ms  worker: notification %d, logger counted %ld so far\n", Ms(), n, idle_counts);
+      if(n == 3){
+         scheduler.Suspend(logger);
+         std::printf("%6.1f ms  worker: logger suspended\n", Ms());
+      }
+   }
+   scheduler.Resume(logger);
+   std::printf("%6.1f ms  worker: logger resumed, done\n", Ms());
+}
+
+static void Logger(void*){
+   for(int i = 0; i < 1000; i++){
+      idle_counts++;
+      scheduler.Delay(100000);
+   }
+   std::printf("%6.1f ms  logger: done\n", Ms());
+}
+
+static const char* StateName(Scheduler::TaskState state){
+   static const char* names[] = {"running", "ready", "blocked", "suspended"};
+   return names[state];
+}
+
+int main(){
+   scheduler.TaskCreate(Sensor, nullptr, 2, Scheduler::DEFAULT_STACK_SIZE, "sensor");
+   worker = scheduler.TaskCreate(Worker, nullptr, 3, Scheduler::DEFAULT_STACK_SIZE, "worker");
+   logger = scheduler.TaskCreate(Logger, nullptr, 1, Scheduler::DEFAULT_STACK_SIZE, "logger");
+   std::printf("%s: %s, %s: %s\n", scheduler.GetName(worker), StateName(scheduler.GetState(worker)),
+               scheduler.GetName(logger), StateName(scheduler.GetState(logger)));
+
+   t0 = Scheduler::Now();
+   scheduler.Start();
+
+   const Scheduler::Stats& stats = scheduler.GetStats();
+   std::printf("%6.1f ms  all tasks done: %zu left, %llu context switches, %llu timer wakeups, %.1f ms idle\n",
+               Ms(), scheduler.NumberOfTasks(), (unsigned long long)stats.context_switches,
+               (unsigned long long)stats.timer_wakeups, stats.idle_ns / 1e6);
+   return 0;
+}
@@ -0,0 +1,550 @@
+/*
+ * this file is a part of FreeRTOS project, https://github.com/over-infinity/-Tutorials/FreeRTOS
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* scheduler.cpp */
+#include "scheduler.h"
+
+#include <cerrno>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if !defined(__x86_64__) && !defined(SCHEDULER_UCONTEXT)
+#define SCHEDULER_UCONTEXT
+#endif
+
+#ifdef SCHEDULER_UCONTEXT
+#include <ucontext.h>
+#endif
+
+/* task control block (TCB_t). The fields used by the lists, the timer queue and the switch
+ * come first, in one cache line */
+struct alignas(64) Scheduler::Task{
+#ifndef SCHEDULER_UCONTEXT
+   void* pxTopOfStack;        /* saved stack pointer, the registers are stored below it */
+#endif
+   /* xStateListItem: in a ready list or in xSuspendedTaskList */
+   Task* next;
+   Task* prev;
+   /* mp_pairheap_t: first child, next sibling and previous sibling (the parent for a first
+    * child), keyed by ph_key, the wake time */
+   Task* ph_child;
+   Task* ph_next;
+   Task* ph_prev;
+   uint64_t ph_key;
+   uint8_t priority;
+   TaskState state;
+   bool in_timer_queue;
+   bool waiting_notify;
+   uint32_t notify_value;
+
+   size_t index;              /* in Scheduler::tasks */
+   Scheduler* owner;
+   TaskFunction code;
+   void* parameters;
+   uint8_t* stack;
+   size_t stack_size;
+   const char* name;
+#ifdef SCHEDULER_UCONTEXT
+   ucontext_t context;
+#endif
+};
+
+void scheduler_task_start(Scheduler::Task* task);
+
+/***********************************************************************************
+ Port layer: pxPortInitialiseStack() and the context switch.
+
+ x86-64 initial frame, from the top of the (16 byte aligned) stack down:
+      port_task_start     return address of the first port_switch() into the task
+      rbp, rbx, r12..r15  rbx = the task, r12 = scheduler_task_start
+                          <- pxTopOfStack
+ port_switch() pushes the callee-saved registers, stores rsp, loads the other rsp, pops
+ and returns on the other stack. The caller-saved registers are already saved by the
+ compiler around the call. MXCSR and the x87 control word are not switched, the tasks
+ share them.
+************************************************************************************/
+#ifndef SCHEDULER_UCONTEXT
+
+extern "C" void port_switch(void** save_sp, void* load_sp);
+extern "C" void port_task_start();
+
+asm(R"(
+   .text
+   .globl port_switch
+   .type port_switch, @function
+port_switch:
+   pushq %rbp
+   pushq %rbx
+   pushq %r12
+   pushq %r13
+   pushq %r14
+   pushq %r15
+   movq %rsp, (%rdi)
+   movq %rsi, %rsp
+   popq %r15
+   popq %r14
+   popq %r13
+   popq %r12
+   popq %rbx
+   popq %rbp
+   ret
+   .size port_switch, .-port_switch
+
+   .globl port_task_start
+   .type port_task_start, @function
+port_task_start:
+   movq %rbx, %rdi
+   callq *%r12
+   ud2
+   .size port_task_start, .-port_task_start
+)");
+
+static void PortInitialiseStack(Scheduler::Task* task){
+   uintptr_t top = reinterpret_cast<uintptr_t>(task->stack + task->stack_size) & ~uintptr_t(15);
+   void** sp = reinterpret_cast<void**>(top);
+   /* after the pops and the ret rsp is 16 byte aligned again, as it must be before a call */
+   *--sp = reinterpret_cast<void*>(&port_task_start);
+   *--sp = nullptr;                                                  /* rbp */
+   *--sp = task;                                                     /* rbx */
+   *--sp = reinterpret_cast<void*>(&scheduler_task_start);           /* r12 */
+   *--sp = nullptr;                                                  /* r13 */
+   *--sp = nullptr;                                                  /* r14 */
+   *--sp = nullptr;                                                  /* r15 */
+   task->pxTopOfStack = sp;
+}
+
+static inline void PortSwitch(Scheduler::Task* from, Scheduler::Task* to){
+   port_switch(&from->pxTopOfStack, to->pxTopOfStack);
+}
+
+#else
+
+/* makecontext() passes int arguments only, the task pointer is split in two */
+static void PortTaskStart(unsigned hi, unsigned lo){
+   scheduler_task_start(reinterpret_cast<Scheduler::Task*>((uintptr_t(hi) << 32) | lo));
+}
+
+static void PortInitialiseStack(Scheduler::Task* task){
+   if(getcontext(&task->context) != 0) throw std::runtime_error("Scheduler: getcontext failed");
+   task->context.uc_stack.ss_sp = task->stack;
+   task->context.uc_stack.ss_size = task->stack_size;
+   task->context.uc_link = nullptr;
+   uintptr_t p = reinterpret_cast<uintptr_t>(task);
+   makecontext(&task->context, reinterpret_cast<void (*)()>(&PortTaskStart), 2, unsigned(uint64_t(p) >> 32),
+               unsigned(p & 0xFFFFFFFFu));
+}
+
+static inline void PortSwitch(Scheduler::Task* from, Scheduler::Task* to){
+   swapcontext(&from->context, &to->context);
+}
+
+#endif
+
+/* first code of every task, on its own stack */
+void scheduler_task_start(Scheduler::Task* task){
+   Scheduler* scheduler = task->owner;
+   scheduler->ReapTerminated();
+   task->code(task->parameters);
+   scheduler->TaskExit();
+}
+
+Scheduler::Scheduler():pxReadyTasksLists(),uxTopReadyPriority(0),xSuspendedTaskList(),timer_queue(nullptr),current(nullptr),start_context(nullptr),terminated(nullptr),free_tasks(nullptr),stats(){
+   start_context = AllocTask();
+}
+
+Scheduler::~Scheduler(){
+   ReapTerminated();
+   for(Task* task : tasks)
+      FreeTask(task);
+   FreeTask(start_context);
+   for(void* chunk : task_chunks)
+      ::operator delete(chunk, std::align_val_t(alignof(Task)));
+}
+
+uint64_t Scheduler::Now(){
+   timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+/* Now() + ns, or MAX_DELAY when the sum does not fit in 64 bits */
+static uint64_t WakeTime(uint64_t ns){
+   uint64_t now = Scheduler::Now();
+   return ns >= Scheduler::MAX_DELAY - now ? Scheduler::MAX_DELAY : now + ns;
+}
+
+Scheduler::TaskHandle Scheduler::TaskCreate(TaskFunction code, void* parameters, unsigned priority, size_t stack_size, const char* name){
+   if(code == nullptr) throw std::invalid_argument("Scheduler: no task function");
+   if(priority >= MAX_PRIORITIES) throw std::invalid_argument("Scheduler: priority out of range");
+   if(stack_size < 1024) throw std::invalid_argument("Scheduler: stack smaller than 1 KB");
+
+   uint8_t* stack = new uint8_t[stack_size];
+   Task* task = AllocTask();
+   task->stack = stack;
+   task->stack_size = stack_size;
+   task->code = code;
+   task->parameters = parameters;
+   task->priority = priority;
+   task->name = name;
+   task->owner = this;
+   PortInitialiseStack(task);
+   task->index = tasks.size();
+   tasks.push_back(task);
+   MakeReady(task);
+   return task;
+}
+
+/* TCBs come from chunks of TASKS_PER_CHUNK, the stacks from the heap: the timer queue and the
+ * lists walk through densely packed TCBs instead of one TCB per stack sized heap block */
+Scheduler::Task* Scheduler::AllocTask(){
+   if(free_tasks == nullptr){
+      Task* chunk = static_cast<Task*>(::operator new(sizeof(Task) * TASKS_PER_CHUNK, std::align_val_t(alignof(Task))));
+      task_chunks.push_back(chunk);
+      for(size_t i = TASKS_PER_CHUNK; i-- > 0;){
+         chunk[i].next = free_tasks;
+         free_tasks = &chunk[i];
+      }
+   }
+   Task* task = free_tasks;
+   free_tasks = task->next;
+   return new(task) Task();
+}
+
+void Scheduler::FreeTask(Task* task){
+   delete[] task->stack;
+   task->~Task();
+   task->next = free_tasks;
+   free_tasks = task;
+}
+
+/***********************************************************************************
+ Lists (xLIST): intrusive, doubly linked through the task itself, O(1) insert and remove
+************************************************************************************/
+void Scheduler::ListPushBack(List& list, Task* task){
+   task->next = nullptr;
+   task->prev = list.tail;
+   if(list.tail) list.tail->next = task;
+   else list.head = task;
+   list.tail = task;
+   list.count++;
+}
+
+void Scheduler::ListPushFront(List& list, Task* task){
+   task->prev = nullptr;
+   task->next = list.head;
+   if(list.head) list.head->prev = task;
+   else list.tail = task;
+   list.head = task;
+   list.count++;
+}
+
+void Scheduler::ListRemove(List& list, Task* task){
+   if(task->prev) task->prev->next = task->next;
+   else list.head = task->next;
+   if(task->next) task->next->prev = task->prev;
+   else list.tail = task->prev;
+   task->next = task->prev = nullptr;
+   list.count--;
+}
+
+/***********************************************************************************
+ Timer queue: pairing heap, like py/pairheap.c
+  - meld: the root with the larger key becomes the first child of the other one, O(1)
+  - pop / remove: the children of the removed node are melded in pairs from left to
+    right, then the pairs from right to left (two pass), amortized O(log n)
+  - remove of any node (a timeout that is cancelled by NotifyGive()): the node is cut out
+    of its sibling list and its merged children are melded with the root
+************************************************************************************/
+Scheduler::Task* Scheduler::HeapMeld(Task* a, Task* b){
+   if(a == nullptr) return b;
+   if(b == nullptr) return a;
+   if(b->ph_key < a->ph_key){
+      Task* t = a;
+      a = b;
+      b = t;
+   }
+   b->ph_next = a->ph_child;
+   if(a->ph_child) a->ph_child->ph_prev = b;
+   b->ph_prev = a;
+   a->ph_child = b;
+   return a;
+}
+
+Scheduler::Task* Scheduler::HeapMergePairs(Task* first){
+   /* first pass: meld pairs, the results are kept in a list linked through ph_next, last pair first */
+   Task* pairs = nullptr;
+   while(first){
+      Task* a = first;
+      Task* b = a->ph_next;
+      first = b ? b->ph_next : nullptr;
+      a->ph_next = a->ph_prev = nullptr;
+      if(b) b->ph_next = b->ph_prev = nullptr;
+      Task* m = HeapMeld(a, b);
+      m->ph_next = pairs;
+      pairs = m;
+   }
+   /* second pass: meld them from right to left */
+   Task* root = nullptr;
+   while(pairs){
+      Task* m = pairs;
+      pairs = m->ph_next;
+      m->ph_next = nullptr;
+      root = HeapMeld(root, m);
+   }
+   return root;
+}
+
+void Scheduler::TimerInsert(Task* task, uint64_t wake){
+   task->ph_key = wake;
+   task->ph_child = task->ph_next = task->ph_prev = nullptr;
+   task->in_timer_queue = true;
+   timer_queue = HeapMeld(timer_queue, task);
+}
+
+void Scheduler::TimerRemove(Task* task){
+   Task* children = task->ph_child;
+   if(children) children->ph_prev = nullptr;
+   if(task == timer_queue){
+      timer_queue = HeapMergePairs(children);
+   }else{
+      if(task->ph_prev->ph_child == task) task->ph_prev->ph_child = task->ph_next;
+      else task->ph_prev->ph_next = task->ph_next;
+      if(task->ph_next) task->ph_next->ph_prev = task->ph_prev;
+      timer_queue = HeapMeld(timer_queue, HeapMergePairs(children));
+   }
+   task->ph_child = task->ph_next = task->ph_prev = nullptr;
+   task->in_timer_queue = false;
+}
+
+/* tasks whose wake time has come go to the end of their ready list, earliest first */
+void Scheduler::ExpireTimers(){
+   if(timer_queue == nullptr) return;
+   uint64_t now = Now();
+   while(timer_queue && timer_queue->ph_key <= now){
+      Task* task = timer_queue;
+      TimerRemove(task);
+      MakeReady(task);
+      stats.timer_wakeups++;
+   }
+}
+
+/***********************************************************************************
+ Ready lists
+************************************************************************************/
+void Scheduler::MakeReady(Task* task, bool front){
+   task->state = eReady;
+   if(front) ListPushFront(pxReadyTasksLists[task->priority], task);
+   else ListPushBack(pxReadyTasksLists[task->priority], task);
+   uxTopReadyPriority |= 1u << task->priority;
+}
+
+/* takes a task out of the list or the timer queue it is in */
+void Scheduler::RemoveFromLists(Task* task){
+   if(task->in_timer_queue){
+      TimerRemove(task);
+   }else if(task->state == eReady){
+      List& list = pxReadyTasksLists[task->priority];
+      ListRemove(list, task);
+      if(list.count == 0) uxTopReadyPriority &= ~(1u << task->priority);
+   }else if(task->state == eSuspended || task->state == eBlocked){
+      /* a blocked task without a timeout waits in xSuspendedTaskList */
+      ListRemove(xSuspendedTaskList, task);
+   }
+}
+
+/* taskSELECT_HIGHEST_PRIORITY_TASK() */
+Scheduler::Task* Scheduler::TakeHighestReady(){
+   unsigned top = 31 - __builtin_clz(uxTopReadyPriority);
+   List& list = pxReadyTasksLists[top];
+   Task* task = list.head;
+   ListRemove(list, task);
+   if(list.count == 0) uxTopReadyPriority &= ~(1u << top);
+   return task;
+}
+
+void Scheduler::RequireTask(const char* what) const{
+   if(current == nullptr) throw std::logic_error(std::string("Scheduler: ") + what + " called outside of a task");
+}
+
+/***********************************************************************************
+ Scheduling. The running task is in no ready list; before Schedule() is called it has been
+ put where it waits (a ready list, the timer queue, xSuspendedTaskList) or it is deleted.
+************************************************************************************/
+void Scheduler::Schedule(){
+   for(;;){
+      ExpireTimers();
+      if(uxTopReadyPriority){
+         Task* next = TakeHighestReady();
+         if(next == current) next->state = eRunning;
+         else SwitchTo(next);
+         return;
+      }
+      if(timer_queue == nullptr){
+         /* nothing can run any more: back to Start() */
+         if(current) SwitchTo(start_context);
+         return;
+      }
+      /* idle: sleep until the earliest timer */
+      uint64_t start = Now();
+      timespec ts;
+      ts.tv_sec = time_t(timer_queue->ph_key / 1000000000u);
+      ts.tv_nsec = long(timer_queue->ph_key % 1000000000u);
+      while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR){
+      }
+      stats.idle_ns += Now() - start;
+   }
+}
+
+void Scheduler::SwitchTo(Task* next){
+   Task* from = current ? current : start_context;
+   current = next == start_context ? nullptr : next;
+   if(current) current->state = eRunning;
+   stats.context_switches++;
+   PortSwitch(from, next);
+   /* running again, on the stack of from */
+   ReapTerminated();
+}
+
+/* a task that has become ready runs at once when its priority is higher than the running one */
+void Scheduler::PreemptIfHigher(Task* task){
+   if(current == nullptr || task->priority <= current->priority) return;
+   MakeReady(current, true);
+   Schedule();
+}
+
+void Scheduler::ReapTerminated(){
+   if(terminated == nullptr) return;
+   FreeTask(terminated);
+   terminated = nullptr;
+}
+
+/* the function of the running task has returned (vTaskDelete(NULL)) */
+void Scheduler::TaskExit(){
+   Task* task = current;
+   tasks.back()->index = task->index;
+   tasks[task->index] = tasks.back();
+   tasks.pop_back();
+   terminated = task;
+   Schedule();
+   /* a deleted task is never switched back to */
+   __builtin_unreachable();
+}
+
+/***********************************************************************************
+ API
+************************************************************************************/
+void Scheduler::Start(){
+   if(current) throw std::logic_error("Scheduler: Start() called from a task");
+   ReapTerminated();
+   Schedule();
+}
+
+void Scheduler::Yield(){
+   RequireTask("Yield()");
+   /* nothing else at this priority or above: keep running */
+   if(uxTopReadyPriority >> current->priority == 0 && timer_queue == nullptr) return;
+   MakeReady(current);
+   Schedule();
+}
+
+void Scheduler::Delay(uint64_t ns){
+   RequireTask("Delay()");
+   if(ns == 0){
+      Yield();
+      return;
+   }
+   /* MAX_DELAY is no time for the timer queue, the latest wake time is one less */
+   uint64_t wake = WakeTime(ns);
+   DelayUntil(wake == MAX_DELAY ? MAX_DELAY - 1 : wake);
+}
+
+void Scheduler::DelayUntil(uint64_t wake){
+   RequireTask("DelayUntil()");
+   current->state = eBlocked;
+   TimerInsert(current, wake);
+   Schedule();
+}
+
+uint32_t Scheduler::NotifyTake(bool clear_on_exit, uint64_t timeout_ns){
+   RequireTask("NotifyTake()");
+   Task* task = current;
+   if(task->notify_value == 0 && timeout_ns != 0){
+      task->state = eBlocked;
+      task->waiting_notify = true;
+      /* a timeout that ends past the clock's range is no timeout, like MAX_DELAY */
+      uint64_t wake = WakeTime(timeout_ns);
+      if(wake == MAX_DELAY) ListPushBack(xSuspendedTaskList, task);
+      else TimerInsert(task, wake);
+      Schedule();
+      task->waiting_notify = false;
+   }
+   uint32_t value = task->notify_value;
+   if(value) task->notify_value = clear_on_exit ? 0 : value - 1;
+   return value;
+}
+
+void Scheduler::NotifyGive(TaskHandle task){
+   task->notify_value++;
+   if(task->state != eBlocked || !task->waiting_notify) return;
+   if(task->in_timer_queue) TimerRemove(task);
+   else ListRemove(xSuspendedTaskList, task);
+   MakeReady(task);
+   PreemptIfHigher(task);
+}
+
+void Scheduler::Suspend(TaskHandle task){
+   if(task == nullptr){
+      RequireTask("Suspend(nullptr)");
+      task = current;
+   }
+   if(task->state == eSuspended) return;
+   if(task != current) RemoveFromLists(task);
+   task->waiting_notify = false;
+   task->state = eSuspended;
+   ListPushBack(xSuspendedTaskList, task);
+   if(task == current) Schedule();
+}
+
+void Scheduler::Resume(TaskHandle task){
+   if(task->state != eSuspended) return;
+   ListRemove(xSuspendedTaskList, task);
+   MakeReady(task);
+   PreemptIfHigher(task);
+}
+
+Scheduler::TaskState Scheduler::GetState(TaskHandle task) const{
+   return task->state;
+}
+
+unsigned Scheduler::GetPriority(TaskHandle task) const{
+   return task->priority;
+}
+
+const char* Scheduler::GetName(TaskHandle task) const{
+   return task->name;
+}
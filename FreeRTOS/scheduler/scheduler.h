@@ -0,0 +1,177 @@
+/*
+ * this file is a part of FreeRTOS project, https://github.com/over-infinity/-Tutorials/FreeRTOS
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* scheduler.h */
+
+/***********************************************************************************
+ Cooperative task scheduler for one Linux thread, after the task life cycle of
+ diagrams/FreeRTOS-TaskLifeCycle.drawio:
+
+   Running    the task that has the CPU (current), it is in no list
+   Ready      pxReadyTasksLists[priority], one intrusive FIFO per priority. Bit p of
+              uxTopReadyPriority is set while list p is not empty, so the highest ready
+              priority is 31 - __builtin_clz(uxTopReadyPriority), like
+              configUSE_PORT_OPTIMISED_TASK_SELECTION.
+   Blocked    Delay(), DelayUntil(), NotifyTake() with a timeout: in the timer queue, a pairing heap
+              keyed by wake time (the mp_pairheap_t / ph_key of uasyncio's task queue,
+              uPyIWM/diagrams/async.drawio). NotifyTake() without a timeout waits in
+              xSuspendedTaskList, like portMAX_DELAY does.
+   Suspended  Suspend(): xSuspendedTaskList until Resume().
+
+ Every task has its own stack. A context switch saves the callee-saved registers on the
+ old stack and loads them from the new one (hand written for x86-64, the way the PendSV
+ handler of diagrams/TaskStackFrame.drawio does it on Cortex-M; ucontext elsewhere or with
+ SCHEDULER_UCONTEXT defined). A task switches straight to the next one, the caller of
+ Start() is only switched back to when no task can run any more.
+
+ There is no tick interrupt: timers are checked at every scheduling point, and a task that
+ wakes a higher priority one (NotifyGive(), Resume()) gives the CPU to it right away.
+ Times are nanoseconds of CLOCK_MONOTONIC. A task function must not throw: there is nothing
+ above it on its stack to catch the exception.
+************************************************************************************/
+
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+////////////////////  Includes ///////////////////
+#include <cstddef>                              //
+#include <cstdint>                              //
+#include <vector>                               //
+//////////////////////////////////////////////////
+
+class Scheduler{
+
+/* Public class methods  */
+public:
+   static const unsigned MAX_PRIORITIES = 32;           /* configMAX_PRIORITIES, 0 is the lowest */
+   static const uint64_t MAX_DELAY = ~uint64_t(0);      /* portMAX_DELAY */
+   static const size_t DEFAULT_STACK_SIZE = 16 * 1024;
+
+   /* there is no eDeleted: see the note on task handles below */
+   enum TaskState : uint8_t { eRunning, eReady, eBlocked, eSuspended };
+
+   typedef void (*TaskFunction)(void* parameters);
+   struct Task;
+   typedef Task* TaskHandle;
+
+   struct Stats{
+      uint64_t context_switches;
+      uint64_t timer_wakeups;     /* tasks moved from the timer queue to a ready list */
+      uint64_t idle_ns;           /* time spent sleeping until the next timer */
+   };
+
+   Scheduler();
+   /* frees the tasks that are still there (suspended or never started) */
+   ~Scheduler();
+   Scheduler(const Scheduler&) = delete;
+   Scheduler& operator=(const Scheduler&) = delete;
+
+   /* xTaskCreate(): the task is ready at once, it runs when Start() is called (or, when it is
+    * created by a running task of lower priority, at the next scheduling point) */
+   TaskHandle TaskCreate(TaskFunction code, void* parameters, unsigned priority,
+                         size_t stack_size = DEFAULT_STACK_SIZE, const char* name = "");
+
+   /* vTaskStartScheduler(): runs the tasks and returns when none is ready or waiting for a
+    * timer any more; suspended tasks and tasks waiting without a timeout are left as they are */
+   void Start();
+
+   /* from inside a task; throw std::logic_error when no task is running */
+   void Yield();
+   /* a delay or timeout that would end past the 64-bit clock is cut to the end of it; for
+    * NotifyTake() that means waiting without a timeout */
+   void Delay(uint64_t ns);
+   /* vTaskDelayUntil(): wakes up at Now() >= wake, right away when that time has passed */
+   void DelayUntil(uint64_t wake);
+   uint32_t NotifyTake(bool clear_on_exit, uint64_t timeout_ns = MAX_DELAY);
+   /* nullptr is the running task */
+   void Suspend(TaskHandle task = nullptr);
+
+   /* from inside or outside a task */
+   void Resume(TaskHandle task);
+   void NotifyGive(TaskHandle task);
+
+   /* A handle is valid until the task function returns. The TCB is freed at the next
+    * context switch and AllocTask() hands it to the next TaskCreate(), so a handle of a
+    * finished task must not be passed to any method: the task that owns it has to be told
+    * (by a notification, or a flag it sets before returning) that the task is done. */
+   TaskHandle CurrentTask() const { return current; }
+   TaskState GetState(TaskHandle task) const;
+   unsigned GetPriority(TaskHandle task) const;
+   const char* GetName(TaskHandle task) const;
+   size_t NumberOfTasks() const { return tasks.size(); }
+   const Stats& GetStats() const { return stats; }
+
+   static uint64_t Now();
+
+/* Private attributes  */
+private:
+   static const size_t TASKS_PER_CHUNK = 1024;
+
+   struct List{ Task* head; Task* tail; size_t count; };
+
+   List pxReadyTasksLists[MAX_PRIORITIES];
+   uint32_t uxTopReadyPriority;      /* bit p: pxReadyTasksLists[p] is not empty */
+   List xSuspendedTaskList;
+   Task* timer_queue;                /* root of the pairing heap */
+
+   Task* current;
+   Task* start_context;              /* the caller of Start(), it has no stack of its own */
+   Task* terminated;                 /* returned from its function, freed after the next switch */
+   Task* free_tasks;                 /* unused TCBs of task_chunks */
+   std::vector<void*> task_chunks;
+   std::vector<Task*> tasks;         /* all tasks, for the destructor */
+   Stats stats;
+
+/* Private class methods  */
+private:
+   Task* AllocTask();
+   void FreeTask(Task* task);
+
+   static void ListPushBack(List& list, Task* task);
+   static void ListPushFront(List& list, Task* task);
+   static void ListRemove(List& list, Task* task);
+
+   static Task* HeapMeld(Task* a, Task* b);
+   static Task* HeapMergePairs(Task* first);
+   void TimerInsert(Task* task, uint64_t wake);
+   void TimerRemove(Task* task);
+   void ExpireTimers();
+
+   void MakeReady(Task* task, bool front = false);
+   void RemoveFromLists(Task* task);
+   Task* TakeHighestReady();
+   void RequireTask(const char* what) const;
+
+   void Schedule();
+   void SwitchTo(Task* next);
+   void PreemptIfHigher(Task* task);
+   void ReapTerminated();
+   [[noreturn]] void TaskExit();
+
+   friend void scheduler_task_start(Task* task);
+};
+
+#endif  // _SCHEDULER_H
@@ -0,0 +1,169 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file cdb_benchmark.cpp
+ * @discription loading .cdb files: the index pass and the parallel decode of hoda::cdb_file
+ *              against a field-at-a-time stream reader that does what the notebook does.
+ *              Prints the same checksum as notebook_loader.py, so the results can be compared.
+ *              usage: cdb_benchmark [threads] [file ...]
+ *              (default: one thread per core, ../dataset/Test_20000.cdb ../dataset/RemainingSamples.cdb)
+ */
+
+#include "cdb_reader.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+double ms_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+struct stream_image
+{
+  int label, width, height;
+  std::vector<uint8_t> pixels;
+};
+
+/* the notebook's loader in C++: one read per field, one allocation per image */
+std::vector<stream_image> load_stream(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  auto u8 = [&in] { return static_cast<uint8_t>(in.get()); };
+  auto u16 = [&u8] { int lo = u8(); return static_cast<uint16_t>(lo | u8() << 8); };
+  in.seekg(4);
+  int H = u8(), W = u8();
+  uint32_t total = 0;
+  in.read(reinterpret_cast<char*>(&total), 4);
+  in.seekg(522);
+  int type = u8();
+  in.seekg(1024);
+
+  std::vector<stream_image> images;
+  for (uint32_t i = 0; i < total; i++) {
+    stream_image img;
+    u8();
+    img.label = u8();
+    img.width = W;
+    img.height = H;
+    if (!(W > 0 && H > 0)) {
+      img.width = u8();
+      img.height = u8();
+    }
+    u16();
+    img.pixels.assign(size_t(img.width) * img.height, 0);
+    if (type == 0) {
+      for (int y = 0; y < img.height; y++) {
+        bool white = true;
+        for (int x = 0; x < img.width;) {
+          int n = u8();
+          for (int k = 0; k < n && x + k < img.width; k++) img.pixels[y * img.width + x + k] = white ? 0 : 255;
+          white = !white;
+          x += n;
+        }
+      }
+    } else {
+      for (int x = 0; x < img.width; x++)
+        for (int y = 0; y < img.height; y++) img.pixels[y * img.width + x] = u8();
+    }
+    images.push_back(std::move(img));
+  }
+  return images;
+}
+
+/* foreground pixels (gray values / 255 for gray files) and label sum, like notebook_loader.py */
+void print_checksum(const char* who, const std::vector<uint8_t>& pixels, const std::vector<uint8_t>& labels)
+{
+  uint64_t ink = 0, label_sum = 0;
+  for (uint8_t p : pixels) ink += p;
+  for (uint8_t l : labels) label_sum += l;
+  std::printf("  %-28s checksum: %zu images, pixel sum %llu, label sum %llu\n", who, labels.size(),
+              static_cast<unsigned long long>(ink), static_cast<unsigned long long>(label_sum));
+}
+
+bool run(const std::string& path, unsigned max_threads)
+{
+  std::printf("%s\n", path.c_str());
+
+  auto start = clock_type::now();
+  hoda::cdb_file file(path);
+  double index_ms = ms_since(start);
+
+  start = clock_type::now();
+  std::vector<stream_image> reference = load_stream(path);
+  double stream_ms = ms_since(start);
+  double mb = file.file_size() / 1e6, mpix = file.pixel_count() / 1e6;
+  std::printf("  %zu records (%s, %s), %.2f MB on disk, %.2f Mpixels decoded\n", file.size(),
+              file.header().type == hoda::image_type::binary ? "binary" : "gray",
+              file.header().fixed_size() ? "fixed size" : "size per record", mb, mpix);
+  std::printf("  %-28s %9.2f ms  %8.0f MB/s\n", "stream reader (notebook way)", stream_ms, mb / stream_ms * 1e3);
+  std::printf("  %-28s %9.2f ms  %8.0f MB/s\n", "mmap + index", index_ms, mb / index_ms * 1e3);
+
+  std::vector<uint8_t> pixels(file.pixel_count()), labels(file.size());
+  std::vector<uint8_t> first;
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+      std::fill(pixels.begin(), pixels.end(), 0x55);
+      start = clock_type::now();
+      size_t malformed = file.decode_all(pixels.data(), labels.data(), threads);
+      best = std::min(best, ms_since(start));
+      if (malformed) {
+        std::printf("  %zu malformed records\n", malformed);
+        return false;
+      }
+    }
+    std::printf("  decode, %2u thread%s            %9.2f ms  %8.0f MB/s  %8.0f Mpixel/s  %8.2f M records/s\n",
+                threads, threads > 1 ? "s" : " ", best, mb / best * 1e3, mpix / best * 1e3,
+                file.size() / best / 1e3);
+    if (first.empty()) first = pixels;
+    else if (first != pixels) {
+      std::printf("  %u threads decoded different pixels\n", threads);
+      return false;
+    }
+    if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+  }
+
+  for (size_t i = 0; i < file.size(); i++) {
+    const hoda::cdb_record& r = file.records()[i];
+    const stream_image& img = reference[i];
+    if (img.label != r.label || img.width != r.width || img.height != r.height ||
+        !std::equal(img.pixels.begin(), img.pixels.end(), pixels.begin() + r.pixels)) {
+      std::printf("  record %zu differs from the stream reader\n", i);
+      return false;
+    }
+  }
+  print_checksum("hoda::cdb_file", pixels, labels);
+  return true;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned threads = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 0;
+  if (threads == 0) threads = hoda::default_threads();
+  std::vector<std::string> files(argv + std::min(argc, 2), argv + argc);
+  if (files.empty()) files = {"../dataset/Test_20000.cdb", "../dataset/RemainingSamples.cdb"};
+
+  try {
+    for (const std::string& f : files)
+      if (!run(f, threads)) return 1;
+  } catch (const std::exception& e) {
+    std::printf("%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
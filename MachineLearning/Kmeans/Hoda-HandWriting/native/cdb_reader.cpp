@@ -0,0 +1,183 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file cdb_reader.cpp
+ */
+
+#include "cdb_reader.h"
+#include "parallel.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hoda
+{
+
+namespace
+{
+
+template <typename T>
+T load(const uint8_t* p)
+{
+  T v;
+  std::memcpy(&v, p, sizeof(T));
+  return v;
+}
+
+} // end namespace
+
+mapped_file::mapped_file(const std::string& path) : data_(nullptr), size_(0)
+{
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error(err, std::generic_category(), "fstat " + path);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0) {
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "mmap " + path);
+    }
+    /* the index pass reads the file front to back, then the decoders read all of it */
+    ::madvise(p, size_, MADV_WILLNEED);
+    data_ = static_cast<const uint8_t*>(p);
+  }
+  ::close(fd);
+}
+
+mapped_file::~mapped_file()
+{
+  if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+cdb_file::cdb_file(const std::string& path) : file_(path), header_(), pixel_count_(0)
+{
+  read_header();
+  build_index();
+}
+
+void cdb_file::read_header()
+{
+  if (file_.size() < HEADER_SIZE) throw std::runtime_error("cdb: file shorter than the header");
+  const uint8_t* p = file_.data();
+  header_.year = load<uint16_t>(p);
+  header_.month = p[2];
+  header_.day = p[3];
+  header_.height = p[4];
+  header_.width = p[5];
+  header_.total_records = load<uint32_t>(p + 6);
+  std::memcpy(header_.letter_count, p + 10, sizeof(header_.letter_count));
+  if (p[522] > 1) throw std::runtime_error("cdb: unknown imgType " + std::to_string(p[522]));
+  header_.type = static_cast<image_type>(p[522]);
+}
+
+void cdb_file::build_index()
+{
+  const uint8_t* base = file_.data();
+  size_t size = file_.size(), pos = HEADER_SIZE;
+  bool fixed = header_.fixed_size();
+  size_t record_header = fixed ? 4 : 6;
+
+  index_.resize(header_.total_records);
+  for (size_t i = 0; i < index_.size(); i++) {
+    if (size - pos < record_header)
+      throw std::runtime_error("cdb: file ends inside record " + std::to_string(i));
+    const uint8_t* p = base + pos;
+    if (p[0] != 0xFF) throw std::runtime_error("cdb: no start byte at record " + std::to_string(i));
+    cdb_record& r = index_[i];
+    r.label = p[1];
+    r.width = fixed ? header_.width : p[2];
+    r.height = fixed ? header_.height : p[3];
+    r.byte_count = load<uint16_t>(p + record_header - 2);
+    r.data = pos + record_header;
+    r.pixels = pixel_count_;
+    /* gray records are W * H bytes whatever ByteCount says, like in the notebook */
+    size_t payload = header_.type == image_type::binary ? r.byte_count : size_t(r.width) * r.height;
+    if (size - r.data < payload)
+      throw std::runtime_error("cdb: file ends inside record " + std::to_string(i));
+    pos = r.data + payload;
+    pixel_count_ += size_t(r.width) * r.height;
+  }
+}
+
+size_t cdb_file::decode(size_t begin, size_t end, uint8_t* pixels, uint8_t* labels) const
+{
+  const uint8_t* base = file_.data();
+  size_t malformed = 0;
+  for (size_t i = begin; i < end; i++) {
+    const cdb_record& r = index_[i];
+    const size_t w = r.width, h = r.height;
+    const uint8_t* src = base + r.data;
+    uint8_t* dst = pixels + r.pixels;
+    labels[i] = r.label;
+
+    if (header_.type == image_type::gray) {
+      for (size_t y = 0; y < h; y++)
+        for (size_t x = 0; x < w; x++) dst[y * w + x] = src[x * h + y];
+      continue;
+    }
+
+    /* runs never cross a row, and the bytes of a record never pass byte_count */
+    const uint8_t* src_end = src + r.byte_count;
+    bool bad = false;
+    for (size_t y = 0; y < h; y++, dst += w) {
+      size_t x = 0;
+      uint8_t color = 0;
+      while (x < w) {
+        if (src == src_end) {
+          std::memset(dst + x, 0, w - x);
+          bad = true;
+          break;
+        }
+        size_t n = *src++;
+        if (n > w - x) {
+          n = w - x;
+          bad = true;
+        }
+        std::memset(dst + x, color, n);
+        x += n;
+        color = static_cast<uint8_t>(~color);
+      }
+    }
+    malformed += bad || src != src_end;
+  }
+  return malformed;
+}
+
+size_t cdb_file::decode_all(uint8_t* pixels, uint8_t* labels, unsigned threads) const
+{
+  std::atomic<size_t> malformed(0);
+  parallel_for(index_.size(), threads, [&](size_t b, size_t e, unsigned) {
+    malformed.fetch_add(decode(b, e, pixels, labels), std::memory_order_relaxed);
+  });
+  return malformed.load();
+}
+
+cdb_dataset load_cdb(const std::string& path, unsigned threads)
+{
+  cdb_file file(path);
+  cdb_dataset set;
+  set.header = file.header();
+  set.records = file.records();
+  set.pixels.resize(file.pixel_count());
+  set.labels.resize(file.size());
+  size_t malformed = file.decode_all(set.pixels.data(), set.labels.data(), threads);
+  if (malformed) throw std::runtime_error("cdb: " + std::to_string(malformed) + " records with broken run lengths");
+  return set;
+}
+
+} // end namespace
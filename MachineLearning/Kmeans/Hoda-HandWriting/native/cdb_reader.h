@@ -0,0 +1,133 @@
+/*
+ * Memory-mapped, parallel reader for the Hoda .cdb format
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file cdb_reader.h
+ *
+ * File layout (little endian), as read by hoda-kmeans.ipynb:
+ *
+ *   header, 1024 bytes
+ *     yy u16 | m u8 | d u8 | H u8 | W u8 | TotalRec u32 | LetterCount u32[128]
+ *     imgType u8 (0 binary, 1 gray) | Comments char[256] | Reserved char[245]
+ *   TotalRec records
+ *     StartByte u8 (0xFF) | label u8 | [W u8 | H u8 when the header has W or H = 0] | ByteCount u16
+ *     binary: per row, run lengths alternating white (0) / black (255), starting with white,
+ *             until the row is W pixels wide. ByteCount is the number of run bytes.
+ *     gray:   W * H bytes, column by column (the notebook reshapes to [W, H] and transposes)
+ *
+ * A record's size is known from its few header bytes, so cdb_file walks the records once
+ * to build an index (file offset of the payload, size, label and the offset of the image
+ * in the decoded tensor). With the index every record can be decoded independently, and
+ * decode_all() splits the records over threads, writing straight into one caller-owned
+ * buffer.
+ *
+ * Decoded images are row-major uint8, 0 background / 255 foreground for binary files,
+ * stored back to back in record order. The images of a file usually have different sizes;
+ * cdb_record::pixels is where an image starts, and width * height is its size.
+ */
+
+#ifndef HODA_CDB_READER_H
+#define HODA_CDB_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hoda
+{
+
+enum class image_type : uint8_t
+{
+  binary = 0,
+  gray = 1
+};
+
+struct cdb_header
+{
+  uint16_t year;
+  uint8_t month, day;
+  uint8_t height, width; /* 0 when every record carries its own size */
+  uint32_t total_records;
+  uint32_t letter_count[128];
+  image_type type;
+
+  bool fixed_size() const { return width > 0 && height > 0; }
+};
+
+struct cdb_record
+{
+  size_t data;   /* file offset of the run lengths / gray bytes */
+  size_t pixels; /* offset of the image in the decoded tensor */
+  uint16_t byte_count;
+  uint8_t width, height;
+  uint8_t label;
+};
+
+/* read-only mmap of a whole file */
+class mapped_file
+{
+public:
+  explicit mapped_file(const std::string& path);
+  ~mapped_file();
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const uint8_t* data_;
+  size_t size_;
+};
+
+class cdb_file
+{
+public:
+  static const size_t HEADER_SIZE = 1024;
+
+  /* maps the file and builds the record index, throws std::runtime_error on a malformed file */
+  explicit cdb_file(const std::string& path);
+
+  const cdb_header& header() const { return header_; }
+  const std::vector<cdb_record>& records() const { return index_; }
+  size_t size() const { return index_.size(); }
+  /* bytes of the decoded tensor */
+  size_t pixel_count() const { return pixel_count_; }
+  size_t file_size() const { return file_.size(); }
+
+  /* decodes records [begin, end). pixels is the whole tensor (pixel_count() bytes) and labels
+   * has size() entries, both indexed as for the whole file. Returns the number of records
+   * whose run lengths did not add up; their missing pixels are left as background. */
+  size_t decode(size_t begin, size_t end, uint8_t* pixels, uint8_t* labels) const;
+  /* all records on `threads` threads (0: one per core) */
+  size_t decode_all(uint8_t* pixels, uint8_t* labels, unsigned threads = 0) const;
+
+private:
+  mapped_file file_;
+  cdb_header header_;
+  std::vector<cdb_record> index_;
+  size_t pixel_count_;
+
+  void read_header();
+  void build_index();
+};
+
+/* a whole file decoded: images back to back plus one label per image */
+struct cdb_dataset
+{
+  cdb_header header;
+  std::vector<cdb_record> records;
+  std::vector<uint8_t> pixels;
+  std::vector<uint8_t> labels;
+
+  size_t size() const { return records.size(); }
+  const uint8_t* image(size_t i) const { return pixels.data() + records[i].pixels; }
+};
+
+/* throws std::runtime_error on a malformed file */
+cdb_dataset load_cdb(const std::string& path, unsigned threads = 0);
+
+} // end namespace
+
+#endif // HODA_CDB_READER_H
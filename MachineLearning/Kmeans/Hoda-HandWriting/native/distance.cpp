@@ -0,0 +1,276 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file distance.cpp
+ */
+
+#include "distance.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HODA_X86 1
+#endif
+
+namespace hoda
+{
+
+void soa_centroids::assign(const float* rows, size_t k_, size_t dim_)
+{
+  k = k_;
+  dim = dim_;
+  stride = (k + LANES - 1) / LANES * LANES;
+  values.assign(dim * stride, 0.0f);
+  norms.assign(stride, FLT_MAX / 4);
+  for (size_t j = 0; j < k; j++) {
+    const float* c = rows + j * dim;
+    float norm = 0;
+    for (size_t d = 0; d < dim; d++) {
+      values[d * stride + j] = c[d];
+      norm += c[d] * c[d];
+    }
+    norms[j] = norm;
+  }
+}
+
+namespace
+{
+
+const size_t TILE = 4; /* points per soa_distances tile, sharing each centroid load */
+
+/***************************** scalar *****************************/
+
+void soa_scalar(const float* const* x, const float* x_norms, size_t rows, const soa_centroids& c, float* out)
+{
+  for (size_t r = 0; r < rows; r++) {
+    float* o = out + r * c.stride;
+    std::fill(o, o + c.stride, 0.0f);
+    for (size_t d = 0; d < c.dim; d++) {
+      const float xd = x[r][d], *col = c.values.data() + d * c.stride;
+      for (size_t j = 0; j < c.stride; j++) o[j] += xd * col[j];
+    }
+    for (size_t j = 0; j < c.stride; j++) o[j] = std::max(0.0f, x_norms[r] - 2 * o[j] + c.norms[j]);
+  }
+}
+
+float sqdist_scalar(const float* a, const float* b, size_t dim)
+{
+  float s = 0;
+  for (size_t i = 0; i < dim; i++) s += (a[i] - b[i]) * (a[i] - b[i]);
+  return s;
+}
+
+float sqnorm_scalar(const float* a, size_t dim)
+{
+  float s = 0;
+  for (size_t i = 0; i < dim; i++) s += a[i] * a[i];
+  return s;
+}
+
+#ifdef HODA_X86
+
+/***************************** AVX2 + FMA *****************************/
+
+__attribute__((target("avx2,fma"))) inline float hsum_avx2(__m256 v)
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_movehdup_ps(s));
+  return _mm_cvtss_f32(s);
+}
+
+/* R points against 16 centroids per step, two registers of 8 each */
+template <size_t R>
+__attribute__((target("avx2,fma"))) void soa_tile_avx2(const float* const* x, const float* x_norms,
+                                                       const soa_centroids& c, float* out)
+{
+  for (size_t cb = 0; cb < c.stride; cb += 16) {
+    __m256 acc[R][2];
+    for (size_t r = 0; r < R; r++) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+    const float* col = c.values.data() + cb;
+    for (size_t d = 0; d < c.dim; d++, col += c.stride) {
+      __m256 c0 = _mm256_loadu_ps(col), c1 = _mm256_loadu_ps(col + 8);
+      for (size_t r = 0; r < R; r++) {
+        __m256 xd = _mm256_broadcast_ss(x[r] + d);
+        acc[r][0] = _mm256_fmadd_ps(xd, c0, acc[r][0]);
+        acc[r][1] = _mm256_fmadd_ps(xd, c1, acc[r][1]);
+      }
+    }
+    __m256 two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+    __m256 n0 = _mm256_loadu_ps(c.norms.data() + cb), n1 = _mm256_loadu_ps(c.norms.data() + cb + 8);
+    for (size_t r = 0; r < R; r++) {
+      __m256 xn = _mm256_set1_ps(x_norms[r]);
+      float* o = out + r * c.stride + cb;
+      _mm256_storeu_ps(o, _mm256_max_ps(zero, _mm256_add_ps(_mm256_fnmadd_ps(two, acc[r][0], n0), xn)));
+      _mm256_storeu_ps(o + 8, _mm256_max_ps(zero, _mm256_add_ps(_mm256_fnmadd_ps(two, acc[r][1], n1), xn)));
+    }
+  }
+}
+
+__attribute__((target("avx2,fma"))) void soa_avx2(const float* const* x, const float* x_norms, size_t rows,
+                                                  const soa_centroids& c, float* out)
+{
+  size_t r = 0;
+  for (; r + TILE <= rows; r += TILE) soa_tile_avx2<TILE>(x + r, x_norms + r, c, out + r * c.stride);
+  switch (rows - r) {
+  case 3: soa_tile_avx2<3>(x + r, x_norms + r, c, out + r * c.stride); break;
+  case 2: soa_tile_avx2<2>(x + r, x_norms + r, c, out + r * c.stride); break;
+  case 1: soa_tile_avx2<1>(x + r, x_norms + r, c, out + r * c.stride); break;
+  }
+}
+
+__attribute__((target("avx2,fma"))) float sqdist_avx2(const float* a, const float* b, size_t dim)
+{
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+    __m256 d2 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16));
+    __m256 d3 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24));
+    s0 = _mm256_fmadd_ps(d0, d0, s0);
+    s1 = _mm256_fmadd_ps(d1, d1, s1);
+    s2 = _mm256_fmadd_ps(d2, d2, s2);
+    s3 = _mm256_fmadd_ps(d3, d3, s3);
+  }
+  for (; i + 8 <= dim; i += 8) {
+    __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    s0 = _mm256_fmadd_ps(d, d, s0);
+  }
+  float s = hsum_avx2(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+  for (; i < dim; i++) s += (a[i] - b[i]) * (a[i] - b[i]);
+  return s;
+}
+
+__attribute__((target("avx2,fma"))) float sqnorm_avx2(const float* a, size_t dim)
+{
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m256 v0 = _mm256_loadu_ps(a + i), v1 = _mm256_loadu_ps(a + i + 8);
+    s0 = _mm256_fmadd_ps(v0, v0, s0);
+    s1 = _mm256_fmadd_ps(v1, v1, s1);
+  }
+  float s = hsum_avx2(_mm256_add_ps(s0, s1));
+  for (; i < dim; i++) s += a[i] * a[i];
+  return s;
+}
+
+/***************************** AVX-512F *****************************/
+
+/* GCC 12's avx512fintrin.h builds _mm512_max_ps / _mm512_reduce_add_ps on a self-initialized
+ * "undefined" vector and warns about it inside every caller */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/* R points against 16 centroids per step, one register */
+template <size_t R>
+__attribute__((target("avx512f"))) void soa_tile_avx512(const float* const* x, const float* x_norms,
+                                                        const soa_centroids& c, float* out)
+{
+  for (size_t cb = 0; cb < c.stride; cb += 16) {
+    __m512 acc[R];
+    for (size_t r = 0; r < R; r++) acc[r] = _mm512_setzero_ps();
+    const float* col = c.values.data() + cb;
+    for (size_t d = 0; d < c.dim; d++, col += c.stride) {
+      __m512 cv = _mm512_loadu_ps(col);
+      for (size_t r = 0; r < R; r++) acc[r] = _mm512_fmadd_ps(_mm512_set1_ps(x[r][d]), cv, acc[r]);
+    }
+    __m512 two = _mm512_set1_ps(2.0f), zero = _mm512_setzero_ps();
+    __m512 n = _mm512_loadu_ps(c.norms.data() + cb);
+    for (size_t r = 0; r < R; r++) {
+      __m512 v = _mm512_add_ps(_mm512_fnmadd_ps(two, acc[r], n), _mm512_set1_ps(x_norms[r]));
+      _mm512_storeu_ps(out + r * c.stride + cb, _mm512_max_ps(zero, v));
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) void soa_avx512(const float* const* x, const float* x_norms, size_t rows,
+                                                   const soa_centroids& c, float* out)
+{
+  size_t r = 0;
+  for (; r + TILE <= rows; r += TILE) soa_tile_avx512<TILE>(x + r, x_norms + r, c, out + r * c.stride);
+  switch (rows - r) {
+  case 3: soa_tile_avx512<3>(x + r, x_norms + r, c, out + r * c.stride); break;
+  case 2: soa_tile_avx512<2>(x + r, x_norms + r, c, out + r * c.stride); break;
+  case 1: soa_tile_avx512<1>(x + r, x_norms + r, c, out + r * c.stride); break;
+  }
+}
+
+__attribute__((target("avx512f"))) float sqdist_avx512(const float* a, const float* b, size_t dim)
+{
+  __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+    s0 = _mm512_fmadd_ps(d0, d0, s0);
+    s1 = _mm512_fmadd_ps(d1, d1, s1);
+  }
+  for (; i < dim; i += 16) {
+    __mmask16 m = dim - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (dim - i)) - 1);
+    __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i));
+    s0 = _mm512_fmadd_ps(d, d, s0);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+__attribute__((target("avx512f"))) float sqnorm_avx512(const float* a, size_t dim)
+{
+  __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m512 v0 = _mm512_loadu_ps(a + i), v1 = _mm512_loadu_ps(a + i + 16);
+    s0 = _mm512_fmadd_ps(v0, v0, s0);
+    s1 = _mm512_fmadd_ps(v1, v1, s1);
+  }
+  for (; i < dim; i += 16) {
+    __mmask16 m = dim - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (dim - i)) - 1);
+    __m512 v = _mm512_maskz_loadu_ps(m, a + i);
+    s0 = _mm512_fmadd_ps(v, v, s0);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+#pragma GCC diagnostic pop
+
+#endif // HODA_X86
+
+} // end namespace
+
+simd_level detect_simd()
+{
+#ifdef HODA_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return simd_level::avx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return simd_level::avx2;
+#endif
+  return simd_level::scalar;
+}
+
+const char* to_string(simd_level level)
+{
+  switch (level) {
+  case simd_level::avx512: return "avx512";
+  case simd_level::avx2: return "avx2";
+  default: return "scalar";
+  }
+}
+
+const distance_kernels& kernels(simd_level level)
+{
+  static const distance_kernels scalar = {soa_scalar, sqdist_scalar, sqnorm_scalar};
+#ifdef HODA_X86
+  static const distance_kernels avx2 = {soa_avx2, sqdist_avx2, sqnorm_avx2};
+  static const distance_kernels avx512 = {soa_avx512, sqdist_avx512, sqnorm_avx512};
+  if (level == simd_level::avx512) return avx512;
+  if (level == simd_level::avx2) return avx2;
+#endif
+  (void)level;
+  return scalar;
+}
+
+} // end namespace
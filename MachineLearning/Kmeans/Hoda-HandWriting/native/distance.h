@@ -0,0 +1,70 @@
+/*
+ * Squared euclidean distance kernels for k-means
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file distance.h
+ *
+ * Two kernels cover what k-means needs:
+ *
+ *  - soa_distances(): one point against all centroids. The centroids are stored as a
+ *    structure of arrays, dimension-major:
+ *
+ *        values[d * stride + j] = element d of centroid j     (stride = k rounded up to 16)
+ *
+ *    so element d of 16 centroids is one AVX-512 register (two AVX2 registers). Going over
+ *    the dimensions, x[d] is broadcast and multiplied into all 16 at once, and a tile of 4
+ *    points shares every centroid load. The distance comes from
+ *    |x - c|^2 = |x|^2 - 2 x.c + |c|^2 with the norms computed once per iteration.
+ *  - squared_distance(): one point against one centroid, for the bound checks of
+ *    Hamerly / Elkan, vectorized along the dimension.
+ *
+ * Each kernel exists as scalar, AVX2+FMA and AVX-512F code, compiled with function target
+ * attributes, so the library does not need -march flags. kernels() picks one at run time.
+ */
+
+#ifndef HODA_DISTANCE_H
+#define HODA_DISTANCE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace hoda
+{
+
+enum class simd_level
+{
+  scalar,
+  avx2,
+  avx512
+};
+
+/* the widest level this CPU supports */
+simd_level detect_simd();
+const char* to_string(simd_level level);
+
+struct soa_centroids
+{
+  static const size_t LANES = 16;
+
+  size_t k = 0, dim = 0, stride = 0;
+  std::vector<float> values; /* dim * stride */
+  std::vector<float> norms;  /* stride, padding columns are huge so they never win */
+
+  /* transposes k row-major centroids of dim floats */
+  void assign(const float* rows, size_t k, size_t dim);
+};
+
+struct distance_kernels
+{
+  /* out[r * c.stride + j] = |x[r] - c_j|^2 for r < rows, x_norms[r] = |x[r]|^2 */
+  void (*soa_distances)(const float* const* x, const float* x_norms, size_t rows, const soa_centroids& c,
+                        float* out);
+  float (*squared_distance)(const float* a, const float* b, size_t dim);
+  float (*squared_norm)(const float* a, size_t dim);
+};
+
+const distance_kernels& kernels(simd_level level);
+
+} // end namespace
+
+#endif // HODA_DISTANCE_H
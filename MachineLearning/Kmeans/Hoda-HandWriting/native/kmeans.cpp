@@ -0,0 +1,484 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file kmeans.cpp
+ */
+
+#include "kmeans.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hoda
+{
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+const uint32_t NO_LABEL = std::numeric_limits<uint32_t>::max();
+const size_t BLOCK = 64; /* points handed to soa_distances at once */
+
+double ms_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+/* never more than the CPU has */
+simd_level usable(simd_level wanted)
+{
+  simd_level have = detect_simd();
+  return static_cast<int>(wanted) > static_cast<int>(have) ? have : wanted;
+}
+
+unsigned usable(unsigned threads)
+{
+  return threads ? threads : default_threads();
+}
+
+/* nearest and second nearest of k squared distances */
+inline void nearest2(const float* d, size_t k, uint32_t& best, float& d1, float& d2)
+{
+  best = 0;
+  d1 = d[0];
+  d2 = std::numeric_limits<float>::max();
+  for (size_t j = 1; j < k; j++) {
+    if (d[j] < d1) {
+      d2 = d1;
+      d1 = d[j];
+      best = static_cast<uint32_t>(j);
+    } else if (d[j] < d2) {
+      d2 = d[j];
+    }
+  }
+}
+
+/* per-thread part of an iteration: changes to the centroid sums caused by points that moved */
+struct partial
+{
+  std::vector<double> delta; /* k x dim */
+  std::vector<int64_t> count;
+  std::vector<char> dirty;
+  size_t reassigned, distances;
+
+  void reset(size_t k, size_t dim)
+  {
+    if (delta.empty()) {
+      delta.assign(k * dim, 0.0);
+      count.assign(k, 0);
+      dirty.assign(k, 0);
+    }
+    reassigned = distances = 0;
+  }
+
+  void move(const float* x, size_t dim, uint32_t from, uint32_t to)
+  {
+    if (from == to) return;
+    reassigned++;
+    if (from != NO_LABEL) {
+      double* s = delta.data() + from * dim;
+      for (size_t d = 0; d < dim; d++) s[d] -= x[d];
+      count[from]--;
+      dirty[from] = 1;
+    }
+    double* s = delta.data() + to * dim;
+    for (size_t d = 0; d < dim; d++) s[d] += x[d];
+    count[to]++;
+    dirty[to] = 1;
+  }
+};
+
+} // end namespace
+
+const char* to_string(kmeans_bounds bounds)
+{
+  switch (bounds) {
+  case kmeans_bounds::elkan: return "elkan";
+  case kmeans_bounds::hamerly: return "hamerly";
+  default: return "lloyd";
+  }
+}
+
+std::vector<float> kmeans_plus_plus(const float* data, size_t n, size_t dim, size_t k, std::mt19937_64& rng,
+                                    unsigned threads, simd_level simd)
+{
+  if (k == 0 || k > n) throw std::invalid_argument("kmeans++: k must be in [1, n]");
+  const distance_kernels& kern = kernels(usable(simd));
+  threads = usable(threads);
+
+  std::vector<float> centroids(k * dim);
+  std::vector<float> min_d2(n, std::numeric_limits<float>::max());
+  size_t pick = rng() % n;
+  for (size_t c = 0;; c++) {
+    const float* center = data + pick * dim;
+    std::copy(center, center + dim, centroids.begin() + c * dim);
+    if (c + 1 == k) break;
+
+    parallel_for(n, threads, [&](size_t b, size_t e, unsigned) {
+      for (size_t i = b; i < e; i++) min_d2[i] = std::min(min_d2[i], kern.squared_distance(data + i * dim, center, dim));
+    });
+    double total = 0;
+    for (float d : min_d2) total += d;
+    if (total <= 0) {
+      pick = rng() % n; /* every point sits on a centroid already */
+      continue;
+    }
+    double r = std::uniform_real_distribution<double>(0, total)(rng), sum = 0;
+    pick = n - 1;
+    for (size_t i = 0; i < n; i++) {
+      sum += min_d2[i];
+      if (sum > r) {
+        pick = i;
+        break;
+      }
+    }
+  }
+  return centroids;
+}
+
+kmeans_result kmeans(const float* data, size_t n, size_t dim, const kmeans_options& options)
+{
+  const size_t k = options.k;
+  if (n == 0 || dim == 0 || k == 0 || k > n) throw std::invalid_argument("kmeans: need 1 <= k <= n and dim > 0");
+  const simd_level simd = usable(options.simd);
+  const distance_kernels& kern = kernels(simd);
+  const unsigned threads = usable(options.threads);
+  const kmeans_bounds bounds = k > 1 ? options.bounds : kmeans_bounds::lloyd;
+
+  kmeans_result res;
+  res.k = k;
+  res.dim = dim;
+  auto start = clock_type::now();
+  std::mt19937_64 rng(options.seed);
+  res.centroids = kmeans_plus_plus(data, n, dim, k, rng, threads, simd);
+  res.init_ms = ms_since(start);
+
+  std::vector<float> x_norms(n);
+  parallel_for(n, threads, [&](size_t b, size_t e, unsigned) {
+    for (size_t i = b; i < e; i++) x_norms[i] = kern.squared_norm(data + i * dim, dim);
+  });
+
+  res.labels.assign(n, NO_LABEL);
+  std::vector<float> upper(n), lower(bounds == kmeans_bounds::elkan ? n * k : n);
+  std::vector<double> sums(k * dim, 0.0);
+  std::vector<int64_t> counts(k, 0);
+  std::vector<float> moved(k, 0.0f), half_min(k), half_cc(k * k);
+  std::vector<partial> parts(threads);
+  soa_centroids soa;
+
+  for (size_t it = 0; it < options.max_iterations; it++) {
+    start = clock_type::now();
+    soa.assign(res.centroids.data(), k, dim);
+    const float* centroids = res.centroids.data();
+
+    /* half distances between centroids, s(a) = half_min[a] */
+    if (bounds != kmeans_bounds::lloyd) {
+      std::fill(half_min.begin(), half_min.end(), std::numeric_limits<float>::max());
+      for (size_t a = 0; a < k; a++)
+        for (size_t j = a + 1; j < k; j++) {
+          float h = 0.5f * std::sqrt(kern.squared_distance(centroids + a * dim, centroids + j * dim, dim));
+          half_cc[a * k + j] = half_cc[j * k + a] = h;
+          half_min[a] = std::min(half_min[a], h);
+          half_min[j] = std::min(half_min[j], h);
+        }
+    }
+    /* the two largest moves of the last update, for the hamerly lower bounds */
+    size_t far = 0;
+    float move1 = 0, move2 = 0;
+    for (size_t j = 0; j < k; j++) {
+      if (moved[j] > move1) {
+        move2 = move1;
+        move1 = moved[j];
+        far = j;
+      } else if (moved[j] > move2) {
+        move2 = moved[j];
+      }
+    }
+
+    parallel_for(n, threads, [&](size_t b, size_t e, unsigned t) {
+      partial& p = parts[t];
+      p.reset(k, dim);
+      std::vector<float> dist(BLOCK * soa.stride), norms(BLOCK);
+      std::vector<const float*> rows(BLOCK);
+      std::vector<size_t> index(BLOCK);
+      size_t pending = 0;
+
+      /* all k distances for the queued points */
+      auto flush = [&] {
+        kern.soa_distances(rows.data(), norms.data(), pending, soa, dist.data());
+        for (size_t r = 0; r < pending; r++) {
+          size_t i = index[r];
+          const float* d = dist.data() + r * soa.stride;
+          uint32_t best;
+          float d1, d2;
+          nearest2(d, k, best, d1, d2);
+          upper[i] = std::sqrt(d1);
+          if (bounds == kmeans_bounds::hamerly) lower[i] = std::sqrt(d2);
+          if (bounds == kmeans_bounds::elkan)
+            for (size_t j = 0; j < k; j++) lower[i * k + j] = std::sqrt(d[j]);
+          p.move(rows[r], dim, res.labels[i], best);
+          res.labels[i] = best;
+        }
+        p.distances += pending * k;
+        pending = 0;
+      };
+      auto queue = [&](size_t i) {
+        rows[pending] = data + i * dim;
+        norms[pending] = x_norms[i];
+        index[pending] = i;
+        if (++pending == BLOCK) flush();
+      };
+
+      for (size_t i = b; i < e; i++) {
+        const float* x = data + i * dim;
+        if (it == 0 || bounds == kmeans_bounds::lloyd) {
+          queue(i);
+        } else if (bounds == kmeans_bounds::hamerly) {
+          uint32_t a = res.labels[i];
+          float u = upper[i] + moved[a];
+          float l = lower[i] - (a == far ? move2 : move1);
+          float m = std::max(half_min[a], l);
+          upper[i] = u;
+          lower[i] = l;
+          if (u <= m) continue;
+          u = upper[i] = std::sqrt(kern.squared_distance(x, centroids + a * dim, dim));
+          p.distances++;
+          if (u > m) queue(i);
+        } else {
+          uint32_t a = res.labels[i];
+          float* lb = lower.data() + i * k;
+          float u = upper[i] + moved[a];
+          for (size_t j = 0; j < k; j++) lb[j] = std::max(0.0f, lb[j] - moved[j]);
+          bool tight = false;
+          if (u > half_min[a]) {
+            for (size_t j = 0; j < k; j++) {
+              if (j == a) continue;
+              float z = std::max(lb[j], half_cc[a * k + j]);
+              if (u <= z) continue;
+              if (!tight) {
+                u = lb[a] = std::sqrt(kern.squared_distance(x, centroids + a * dim, dim));
+                p.distances++;
+                tight = true;
+                if (u <= z) continue;
+              }
+              float dj = lb[j] = std::sqrt(kern.squared_distance(x, centroids + j * dim, dim));
+              p.distances++;
+              if (dj < u) {
+                a = static_cast<uint32_t>(j);
+                u = dj;
+              }
+            }
+          }
+          upper[i] = u;
+          p.move(x, dim, res.labels[i], a);
+          res.labels[i] = a;
+        }
+      }
+      if (pending) flush();
+    });
+
+    /* fold the changes into the sums, move the centroids (an empty cluster keeps its centroid) */
+    kmeans_iteration rec{0, 0, 0, 0};
+    for (partial& p : parts) {
+      if (p.delta.empty()) continue;
+      rec.reassigned += p.reassigned;
+      rec.distances += p.distances;
+      for (size_t j = 0; j < k; j++) {
+        if (!p.dirty[j]) continue;
+        double* s = sums.data() + j * dim;
+        double* d = p.delta.data() + j * dim;
+        for (size_t x = 0; x < dim; x++) {
+          s[x] += d[x];
+          d[x] = 0;
+        }
+        counts[j] += p.count[j];
+        p.count[j] = 0;
+        p.dirty[j] = 0;
+      }
+    }
+    std::vector<float> next(dim);
+    for (size_t j = 0; j < k; j++) {
+      moved[j] = 0;
+      if (counts[j] <= 0) continue;
+      for (size_t x = 0; x < dim; x++) next[x] = static_cast<float>(sums[j * dim + x] / counts[j]);
+      float* c = res.centroids.data() + j * dim;
+      moved[j] = std::sqrt(kern.squared_distance(c, next.data(), dim));
+      std::copy(next.begin(), next.end(), c);
+      rec.max_shift = std::max(rec.max_shift, moved[j]);
+    }
+    rec.ms = ms_since(start);
+    res.iterations.push_back(rec);
+    if (rec.reassigned == 0 || (it > 0 && rec.max_shift <= options.tolerance)) break;
+  }
+
+  std::vector<double> inertia(threads, 0.0);
+  parallel_for(n, threads, [&](size_t b, size_t e, unsigned t) {
+    for (size_t i = b; i < e; i++)
+      inertia[t] += kern.squared_distance(data + i * dim, res.centroids.data() + res.labels[i] * dim, dim);
+  });
+  for (double v : inertia) res.inertia += v;
+  return res;
+}
+
+double kmeans_assign(const float* data, size_t n, size_t dim, const std::vector<float>& centroids,
+                     uint32_t* labels, unsigned threads, simd_level simd)
+{
+  const distance_kernels& kern = kernels(usable(simd));
+  threads = usable(threads);
+  size_t k = centroids.size() / dim;
+  if (k == 0) throw std::invalid_argument("kmeans_assign: no centroids");
+  soa_centroids soa;
+  soa.assign(centroids.data(), k, dim);
+
+  std::vector<double> inertia(threads, 0.0);
+  parallel_for(n, threads, [&](size_t b, size_t e, unsigned t) {
+    std::vector<float> dist(BLOCK * soa.stride), norms(BLOCK);
+    std::vector<const float*> rows(BLOCK);
+    for (size_t i = b; i < e; i += BLOCK) {
+      size_t count = std::min(BLOCK, e - i);
+      for (size_t r = 0; r < count; r++) {
+        rows[r] = data + (i + r) * dim;
+        norms[r] = kern.squared_norm(rows[r], dim);
+      }
+      kern.soa_distances(rows.data(), norms.data(), count, soa, dist.data());
+      for (size_t r = 0; r < count; r++) {
+        uint32_t best;
+        float d1, d2;
+        nearest2(dist.data() + r * soa.stride, k, best, d1, d2);
+        labels[i + r] = best;
+        inertia[t] += d1;
+      }
+    }
+  });
+  double total = 0;
+  for (double v : inertia) total += v;
+  return total;
+}
+
+/***************************** mini-batch *****************************/
+
+memory_source::memory_source(const float* data, size_t n, size_t dim, uint64_t seed)
+    : data_(data), n_(n), dim_(dim), rng_(seed)
+{
+}
+
+size_t memory_source::next(float* out, size_t rows)
+{
+  if (n_ == 0) return 0;
+  for (size_t r = 0; r < rows; r++) {
+    const float* row = data_ + (rng_() % n_) * dim_;
+    std::copy(row, row + dim_, out + r * dim_);
+  }
+  return rows;
+}
+
+file_source::file_source(const std::string& path, size_t dim, size_t offset, uint64_t seed)
+    : fd_(-1), n_(0), dim_(dim), offset_(offset), rng_(seed)
+{
+  if (dim == 0) throw std::invalid_argument("file_source: dim must be > 0");
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+  struct stat st;
+  if (::fstat(fd_, &st) != 0) {
+    int err = errno;
+    ::close(fd_);
+    throw std::system_error(err, std::generic_category(), "fstat " + path);
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  n_ = size > offset ? (size - offset) / (dim * sizeof(float)) : 0;
+}
+
+file_source::~file_source()
+{
+  if (fd_ >= 0) ::close(fd_);
+}
+
+size_t file_source::next(float* out, size_t rows)
+{
+  if (n_ == 0) return 0;
+  size_t blocks = (n_ + BLOCK_ROWS - 1) / BLOCK_ROWS, filled = 0;
+  while (filled < rows) {
+    size_t first = (rng_() % blocks) * BLOCK_ROWS;
+    size_t count = std::min({BLOCK_ROWS, n_ - first, rows - filled});
+    char* dst = reinterpret_cast<char*>(out + filled * dim_);
+    size_t bytes = count * dim_ * sizeof(float), done = 0;
+    off_t pos = static_cast<off_t>(offset_ + first * dim_ * sizeof(float));
+    while (done < bytes) {
+      ssize_t got = ::pread(fd_, dst + done, bytes - done, pos + static_cast<off_t>(done));
+      if (got < 0 && errno == EINTR) continue;
+      if (got <= 0) throw std::system_error(got < 0 ? errno : EIO, std::generic_category(), "file_source: pread");
+      done += static_cast<size_t>(got);
+    }
+    filled += count;
+  }
+  return filled;
+}
+
+kmeans_result minibatch_kmeans(batch_source& source, const minibatch_options& options)
+{
+  const size_t k = options.k, dim = source.dim(), batch = options.batch_size;
+  if (k == 0 || batch == 0) throw std::invalid_argument("minibatch_kmeans: k and batch_size must be > 0");
+  const simd_level simd = usable(options.simd);
+  const distance_kernels& kern = kernels(simd);
+  const unsigned threads = usable(options.threads);
+
+  kmeans_result res;
+  res.k = k;
+  res.dim = dim;
+  auto start = clock_type::now();
+  std::vector<float> buffer(std::max(options.init_rows, k) * dim);
+  size_t rows = source.next(buffer.data(), buffer.size() / dim);
+  if (rows < k) throw std::invalid_argument("minibatch_kmeans: source has fewer than k rows");
+  std::mt19937_64 rng(options.seed);
+  res.centroids = kmeans_plus_plus(buffer.data(), rows, dim, k, rng, threads, simd);
+  res.init_ms = ms_since(start);
+
+  buffer.assign(batch * dim, 0.0f);
+  std::vector<uint32_t> labels(batch);
+  std::vector<double> seen(k, 0.0), sums(k * dim);
+  std::vector<int64_t> counts(k);
+  std::vector<float> next(dim);
+  for (size_t it = 0; it < options.iterations; it++) {
+    start = clock_type::now();
+    rows = source.next(buffer.data(), batch);
+    if (rows == 0) break;
+    res.inertia = kmeans_assign(buffer.data(), rows, dim, res.centroids, labels.data(), threads, simd);
+
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(counts.begin(), counts.end(), 0);
+    for (size_t r = 0; r < rows; r++) {
+      const float* x = buffer.data() + r * dim;
+      double* s = sums.data() + labels[r] * dim;
+      for (size_t d = 0; d < dim; d++) s[d] += x[d];
+      counts[labels[r]]++;
+    }
+    /* c += (sum - count * c) / seen: the mean of all points ever assigned, weighted by arrival */
+    kmeans_iteration rec{0, 0, rows * k, 0};
+    for (size_t j = 0; j < k; j++) {
+      if (counts[j] == 0) continue;
+      seen[j] += counts[j];
+      float* c = res.centroids.data() + j * dim;
+      for (size_t d = 0; d < dim; d++)
+        next[d] = static_cast<float>(c[d] + (sums[j * dim + d] - counts[j] * double(c[d])) / seen[j]);
+      rec.max_shift = std::max(rec.max_shift, std::sqrt(kern.squared_distance(c, next.data(), dim)));
+      std::copy(next.begin(), next.end(), c);
+    }
+    rec.ms = ms_since(start);
+    res.iterations.push_back(rec);
+  }
+  return res;
+}
+
+} // end namespace
@@ -0,0 +1,157 @@
+/*
+ * K-means: k-means++ seeding, Lloyd / Hamerly / Elkan iterations and mini-batch k-means
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file kmeans.h
+ *
+ * The points are row-major floats (n x dim, e.g. the 32x32 images of the notebook as 1024
+ * floats each). An iteration assigns every point to its nearest centroid, then moves each
+ * centroid to the mean of its points.
+ *
+ *  - lloyd:   every point against every centroid, k distances per point, computed with the
+ *             structure-of-arrays kernel of distance.h.
+ *  - hamerly: per point an upper bound u on the distance to its own centroid and one lower
+ *             bound l on the distance to any other. When u <= max(l, s(a)), with s(a) half
+ *             the distance from centroid a to its nearest other centroid, the point cannot
+ *             move and no distance is computed. After the update u grows by the distance its
+ *             centroid moved and l shrinks by the largest move of any other centroid.
+ *  - elkan:   one lower bound per point and centroid plus all centroid-centroid distances;
+ *             skips more distances than hamerly, at the price of n * k bounds.
+ *
+ * The three give the same clustering for the same seed (up to float rounding); the
+ * bounds only save distance computations. kmeans_iteration::distances counts the
+ * point-centroid distances an iteration computed.
+ *
+ * minibatch_kmeans() never holds more than a batch of points: it pulls batches from a
+ * batch_source (e.g. file_source, which streams rows from a raw float32 file) and moves
+ * every centroid towards the points of the batch assigned to it, with a per-centroid
+ * learning rate of 1 / (points seen so far) (Sculley, "Web-scale k-means clustering").
+ */
+
+#ifndef HODA_KMEANS_H
+#define HODA_KMEANS_H
+
+#include "distance.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace hoda
+{
+
+enum class kmeans_bounds
+{
+  lloyd,
+  hamerly,
+  elkan
+};
+
+const char* to_string(kmeans_bounds bounds);
+
+struct kmeans_options
+{
+  size_t k = 10;
+  size_t max_iterations = 100;
+  float tolerance = 0.0f; /* stop when no centroid moves further than this (and when no point moves) */
+  kmeans_bounds bounds = kmeans_bounds::hamerly;
+  unsigned threads = 0;   /* 0: one per core */
+  uint64_t seed = 1;
+  simd_level simd = detect_simd();
+};
+
+struct kmeans_iteration
+{
+  double ms;
+  size_t reassigned; /* points that changed centroid */
+  size_t distances;  /* point-centroid distances computed */
+  float max_shift;   /* largest centroid move */
+};
+
+struct kmeans_result
+{
+  size_t k = 0, dim = 0;
+  std::vector<float> centroids; /* k x dim */
+  std::vector<uint32_t> labels; /* one per point, empty for mini-batch */
+  double inertia = 0;           /* sum of squared distances to the nearest centroid */
+  double init_ms = 0;
+  std::vector<kmeans_iteration> iterations;
+};
+
+/* k-means++ seeding: k rows of data, each picked with probability proportional to its squared
+ * distance to the nearest row picked before */
+std::vector<float> kmeans_plus_plus(const float* data, size_t n, size_t dim, size_t k, std::mt19937_64& rng,
+                                    unsigned threads = 0, simd_level simd = detect_simd());
+
+kmeans_result kmeans(const float* data, size_t n, size_t dim, const kmeans_options& options = kmeans_options());
+
+/* nearest centroid of every point into labels (n entries), returns the inertia */
+double kmeans_assign(const float* data, size_t n, size_t dim, const std::vector<float>& centroids,
+                     uint32_t* labels, unsigned threads = 0, simd_level simd = detect_simd());
+
+/* where mini-batch k-means gets its points from */
+class batch_source
+{
+public:
+  virtual ~batch_source() = default;
+  virtual size_t dim() const = 0;
+  /* writes up to `rows` rows of dim() floats to out, returns how many */
+  virtual size_t next(float* out, size_t rows) = 0;
+};
+
+/* random rows of an array in memory */
+class memory_source : public batch_source
+{
+public:
+  memory_source(const float* data, size_t n, size_t dim, uint64_t seed = 1);
+  size_t dim() const override { return dim_; }
+  size_t next(float* out, size_t rows) override;
+
+private:
+  const float* data_;
+  size_t n_, dim_;
+  std::mt19937_64 rng_;
+};
+
+/* rows of a raw float32 file (n x dim after `offset` header bytes), read with pread in
+ * blocks of BLOCK_ROWS consecutive rows at random positions, so only the batch is in memory */
+class file_source : public batch_source
+{
+public:
+  static const size_t BLOCK_ROWS = 64;
+
+  file_source(const std::string& path, size_t dim, size_t offset = 0, uint64_t seed = 1);
+  ~file_source() override;
+  file_source(const file_source&) = delete;
+  file_source& operator=(const file_source&) = delete;
+
+  size_t dim() const override { return dim_; }
+  size_t rows() const { return n_; }
+  size_t next(float* out, size_t rows) override;
+
+private:
+  int fd_;
+  size_t n_, dim_, offset_;
+  std::mt19937_64 rng_;
+};
+
+struct minibatch_options
+{
+  size_t k = 10;
+  size_t batch_size = 1024;
+  size_t iterations = 100;  /* batches */
+  size_t init_rows = 10000; /* rows pulled for k-means++ seeding */
+  unsigned threads = 0;
+  uint64_t seed = 1;
+  simd_level simd = detect_simd();
+};
+
+/* centroids only: labels stay empty and inertia is that of the last batch, use
+ * kmeans_assign() for the whole data when it fits */
+kmeans_result minibatch_kmeans(batch_source& source, const minibatch_options& options = minibatch_options());
+
+} // end namespace
+
+#endif // HODA_KMEANS_H
@@ -0,0 +1,218 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file kmeans_benchmark.cpp
+ * @discription k-means on the Hoda digits as the notebook prepares them (32x32, binarized):
+ *              distance kernels per SIMD level, Lloyd / Hamerly / Elkan per iteration,
+ *              thread scaling and mini-batch k-means streaming from a file, on Test_20000
+ *              and on all samples (Test_20000 + RemainingSamples).
+ *              The 32x32 tensors come from the cache of tensor_cache.h.
+ *              usage: kmeans_benchmark [k] [threads] [dataset dir] [cache dir]
+ *                     (default 10, one per core, ../dataset, hoda_cache)
+ */
+
+#include "kmeans.h"
+#include "parallel.h"
+#include "tensor_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+const size_t SIDE = 32, DIM = SIDE * SIDE;
+
+double ms_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+struct dataset
+{
+  std::string name;
+  size_t n = 0;
+  std::vector<float> x; /* n x DIM */
+  std::vector<uint8_t> labels;
+};
+
+/* the images of path as the notebook prepares them, from the tensor cache */
+void append(dataset& set, const std::string& path, const std::string& cache_dir)
+{
+  hoda::tensor_file t = hoda::open_preprocessed(path, cache_dir);
+  set.x.insert(set.x.end(), t.data(), t.data() + t.size() * DIM);
+  set.labels.insert(set.labels.end(), t.labels(), t.labels() + t.size());
+  set.n += t.size();
+}
+
+/* share of points whose cluster's most common digit is their own */
+double purity(const dataset& set, const std::vector<uint32_t>& labels, size_t k)
+{
+  std::vector<size_t> table(k * 256, 0);
+  for (size_t i = 0; i < set.n; i++) table[labels[i] * 256 + set.labels[i]]++;
+  size_t hit = 0;
+  for (size_t j = 0; j < k; j++) hit += *std::max_element(table.begin() + j * 256, table.begin() + (j + 1) * 256);
+  return double(hit) / set.n;
+}
+
+double total_ms(const hoda::kmeans_result& r)
+{
+  double ms = 0;
+  for (const hoda::kmeans_iteration& it : r.iterations) ms += it.ms;
+  return ms;
+}
+
+size_t total_distances(const hoda::kmeans_result& r)
+{
+  size_t d = 0;
+  for (const hoda::kmeans_iteration& it : r.iterations) d += it.distances;
+  return d;
+}
+
+bool run(const dataset& set, size_t k, unsigned max_threads)
+{
+  std::printf("\n== %s: %zu images of %zu floats, k = %zu ==\n", set.name.c_str(), set.n, DIM, k);
+
+  /* kernels: one assignment pass against the k-means++ centroids */
+  std::mt19937_64 rng(1);
+  std::vector<float> seeds = hoda::kmeans_plus_plus(set.x.data(), set.n, DIM, k, rng, max_threads);
+  std::vector<uint32_t> reference(set.n), labels(set.n);
+  std::printf("assignment kernel, %u threads:\n", max_threads);
+  for (int level = 0; level <= static_cast<int>(hoda::detect_simd()); level++) {
+    hoda::simd_level simd = static_cast<hoda::simd_level>(level);
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+      auto start = clock_type::now();
+      hoda::kmeans_assign(set.x.data(), set.n, DIM, seeds, (level ? labels : reference).data(), max_threads, simd);
+      best = std::min(best, ms_since(start));
+    }
+    size_t differ = 0;
+    if (level)
+      for (size_t i = 0; i < set.n; i++) differ += labels[i] != reference[i];
+    std::printf("  %-8s %8.2f ms  %8.0f M distances/s  %6.1f GFLOP/s  (%zu labels differ from scalar)\n",
+                hoda::to_string(simd), best, set.n * k / best / 1e3, 2.0 * set.n * k * DIM / best / 1e6, differ);
+    if (differ > set.n / 1000) {
+      std::printf("FAILED: %s labels differ from scalar for %zu of %zu images (at most %zu allowed)\n",
+                  hoda::to_string(simd), differ, set.n, set.n / 1000);
+      return false;
+    }
+  }
+
+  /* the three iteration schemes, same seed */
+  hoda::kmeans_options opt;
+  opt.k = k;
+  opt.threads = max_threads;
+  std::printf("%-8s %6s %10s %10s %14s %10s %8s\n", "bounds", "iters", "init ms", "iter ms", "distances",
+              "inertia", "purity");
+  double lloyd_inertia = 0;
+  for (hoda::kmeans_bounds b : {hoda::kmeans_bounds::lloyd, hoda::kmeans_bounds::hamerly, hoda::kmeans_bounds::elkan}) {
+    opt.bounds = b;
+    hoda::kmeans_result r = hoda::kmeans(set.x.data(), set.n, DIM, opt);
+    std::printf("%-8s %6zu %10.1f %10.1f %14zu %10.0f %7.1f%%\n", hoda::to_string(b), r.iterations.size(), r.init_ms,
+                total_ms(r), total_distances(r), r.inertia, 100 * purity(set, r.labels, k));
+    if (b == hoda::kmeans_bounds::lloyd) lloyd_inertia = r.inertia;
+    else if (std::fabs(r.inertia - lloyd_inertia) > 0.01 * lloyd_inertia) {
+      std::printf("FAILED: %s inertia %.0f is more than 1%% away from lloyd inertia %.0f\n", hoda::to_string(b),
+                  r.inertia, lloyd_inertia);
+      return false;
+    }
+  }
+
+  /* per iteration, hamerly against lloyd */
+  opt.bounds = hoda::kmeans_bounds::lloyd;
+  hoda::kmeans_result lloyd = hoda::kmeans(set.x.data(), set.n, DIM, opt);
+  opt.bounds = hoda::kmeans_bounds::hamerly;
+  hoda::kmeans_result hamerly = hoda::kmeans(set.x.data(), set.n, DIM, opt);
+  std::printf("%5s %12s %12s %12s %12s %10s\n", "iter", "lloyd ms", "hamerly ms", "distances", "reassigned",
+              "max shift");
+  for (size_t i = 0; i < hamerly.iterations.size(); i++) {
+    const hoda::kmeans_iteration& h = hamerly.iterations[i];
+    double l = i < lloyd.iterations.size() ? lloyd.iterations[i].ms : 0;
+    std::printf("%5zu %12.2f %12.2f %12zu %12zu %10.4f\n", i, l, h.ms, h.distances, h.reassigned, h.max_shift);
+  }
+
+  /* thread scaling, ms per iteration */
+  std::printf("%8s %14s %14s %14s\n", "threads", "lloyd ms/it", "hamerly ms/it", "elkan ms/it");
+  std::vector<unsigned> counts;
+  for (unsigned threads = 1; threads < max_threads; threads *= 2) counts.push_back(threads);
+  counts.push_back(max_threads);
+  double base[3] = {0, 0, 0};
+  for (unsigned threads : counts) {
+    opt.threads = threads;
+    opt.max_iterations = 20;
+    std::printf("%8u", threads);
+    int col = 0;
+    for (hoda::kmeans_bounds b : {hoda::kmeans_bounds::lloyd, hoda::kmeans_bounds::hamerly, hoda::kmeans_bounds::elkan}) {
+      opt.bounds = b;
+      hoda::kmeans_result r = hoda::kmeans(set.x.data(), set.n, DIM, opt);
+      double per = total_ms(r) / r.iterations.size();
+      if (threads == 1) base[col] = per;
+      std::printf(" %8.2f (x%3.1f)", per, base[col] / per);
+      col++;
+    }
+    std::printf("\n");
+  }
+
+  /* mini-batch from a raw float32 file: only a batch of points in memory at a time */
+  std::string path = "kmeans_" + set.name + ".f32";
+  {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    bool written = f && std::fwrite(set.x.data(), sizeof(float), set.x.size(), f) == set.x.size();
+    if (f) std::fclose(f);
+    if (!written) {
+      std::printf("FAILED: cannot write %s\n", path.c_str());
+      return false;
+    }
+  }
+  hoda::file_source source(path, DIM);
+  hoda::minibatch_options mb;
+  mb.k = k;
+  mb.threads = max_threads;
+  mb.batch_size = 1024;
+  mb.iterations = 200;
+  mb.init_rows = 4096;
+  hoda::kmeans_result r = hoda::minibatch_kmeans(source, mb);
+  double inertia = hoda::kmeans_assign(set.x.data(), set.n, DIM, r.centroids, labels.data(), max_threads);
+  std::printf("mini-batch %zu x %zu rows: init %.1f ms, %.1f ms, inertia %.0f (%.3f of lloyd), purity %.1f%%\n",
+              mb.iterations, mb.batch_size, r.init_ms, total_ms(r), inertia, inertia / lloyd_inertia,
+              100 * purity(set, labels, k));
+  std::remove(path.c_str());
+  return true;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  size_t k = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10;
+  unsigned threads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 0;
+  std::string dir = argc > 3 ? argv[3] : "../dataset";
+  std::string cache_dir = argc > 4 ? argv[4] : "hoda_cache";
+  if (threads == 0) threads = hoda::default_threads();
+  std::printf("SIMD: %s, threads: %u\n", hoda::to_string(hoda::detect_simd()), threads);
+
+  try {
+    auto start = clock_type::now();
+    dataset test;
+    test.name = "Test_20000";
+    append(test, dir + "/Test_20000.cdb", cache_dir);
+    dataset all = test;
+    all.name = "all";
+    append(all, dir + "/RemainingSamples.cdb", cache_dir);
+    std::printf("load (tensor cache): %.1f ms\n", ms_since(start));
+
+    if (!run(test, k, threads) || !run(all, k, threads)) return 1;
+  } catch (const std::exception& e) {
+    std::printf("%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+# Times the .cdb loader of hoda-kmeans.ipynb (the same code, wrapped in a function) and prints
+# the checksum line of cdb_benchmark, so both can be compared on the same files. When cv2 is
+# installed the notebook's resize + binarization is timed too, and its "notebook X checksum"
+# line can be compared with the one of preprocess_benchmark.
+# usage: python3 notebook_loader.py [file ...]
+
+import struct
+import sys
+import time
+
+import numpy as np
+
+
+def read_cdb(path):
+    with open(path, 'rb') as binary_file:
+
+        data = binary_file.read()
+
+        offset = 0
+
+        # read private header
+
+        yy = struct.unpack_from('H', data, offset)[0]
+        offset += 2
+
+        m = struct.unpack_from('B', data, offset)[0]
+        offset += 1
+
+        d = struct.unpack_from('B', data, offset)[0]
+        offset += 1
+
+        H = struct.unpack_from('B', data, offset)[0]
+        offset += 1
+
+        W = struct.unpack_from('B', data, offset)[0]
+        offset += 1
+
+        TotalRec = struct.unpack_from('I', data, offset)[0]
+        offset += 4
+
+        LetterCount = struct.unpack_from('128I', data, offset)
+        offset += 128 * 4
+
+        imgType = struct.unpack_from('B', data, offset)[0]  # 0: binary, 1: gray
+        offset += 1
+
+        Comments = struct.unpack_from('256c', data, offset)
+        offset += 256 * 1
+
+        Reserved = struct.unpack_from('245c', data, offset)
+        offset += 245 * 1
+
+        if (W > 0) and (H > 0):
+            normal = True
+        else:
+            normal = False
+
+        images = []
+        labels = []
+
+        for i in range(TotalRec):
+
+            StartByte = struct.unpack_from('B', data, offset)[0]  # must be 0xff
+            offset += 1
+
+            label = struct.unpack_from('B', data, offset)[0]
+            offset += 1
+
+            if not normal:
+                W = struct.unpack_from('B', data, offset)[0]
+                offset += 1
+
+                H = struct.unpack_from('B', data, offset)[0]
+                offset += 1
+
+            ByteCount = struct.unpack_from('H', data, offset)[0]
+            offset += 2
+
+            image = np.zeros(shape=[H, W], dtype=np.uint8)
+
+            if imgType == 0:
+                # Binary
+                for y in range(H):
+                    bWhite = True
+                    counter = 0
+                    while counter < W:
+                        WBcount = struct.unpack_from('B', data, offset)[0]
+                        offset += 1
+                        if bWhite:
+                            image[y, counter:counter + WBcount] = 0  # Background
+                        else:
+                            image[y, counter:counter + WBcount] = 255  # ForeGround
+                        bWhite = not bWhite  # black white black white ...
+                        counter += WBcount
+            else:
+                # GrayScale mode (the notebook rebinds `data` here, which breaks the next record)
+                pixels = struct.unpack_from('{}B'.format(W * H), data, offset)
+                offset += W * H
+                image = np.asarray(pixels, dtype=np.uint8).reshape([W, H]).T
+
+            images.append(image)
+            labels.append(label)
+
+    return images, labels, len(data)
+
+
+def resize_image(src_image, dst_image_height, dst_image_width):
+    import cv2
+
+    src_image_height = src_image.shape[0]
+    src_image_width = src_image.shape[1]
+
+    if src_image_height > dst_image_height or src_image_width > dst_image_width:
+        height_scale = dst_image_height / src_image_height
+        width_scale = dst_image_width / src_image_width
+        scale = min(height_scale, width_scale)
+        img = cv2.resize(src=src_image, dsize=(0, 0), fx=scale, fy=scale, interpolation=cv2.INTER_CUBIC)
+    else:
+        img = src_image
+
+    img_height = img.shape[0]
+    img_width = img.shape[1]
+
+    dst_image = np.zeros(shape=[dst_image_height, dst_image_width], dtype=np.uint8)
+
+    y_offset = (dst_image_height - img_height) // 2
+    x_offset = (dst_image_width - img_width) // 2
+
+    dst_image[y_offset:y_offset+img_height, x_offset:x_offset+img_width] = img
+
+    return dst_image
+
+
+def preprocess(images, images_height=32, images_width=32):
+    X = np.zeros(shape=[len(images), images_height, images_width], dtype=np.float32)
+    for i in range(len(images)):
+        image = resize_image(src_image=images[i], dst_image_height=images_height, dst_image_width=images_width)
+        image = image / 255
+        image = np.where(image >= 0.5, 1, 0)
+        X[i] = image
+    return X
+
+
+def main():
+    files = sys.argv[1:] or ['../dataset/Test_20000.cdb', '../dataset/RemainingSamples.cdb']
+    for path in files:
+        start = time.perf_counter()
+        images, labels, size = read_cdb(path)
+        ms = (time.perf_counter() - start) * 1e3
+        pixels = sum(int(image.sum(dtype=np.uint64)) for image in images)
+        print(path)
+        print('  %-28s %9.2f ms  %8.1f MB/s  %8.3f M records/s' % ('notebook loader', ms, size / 1e6 / ms * 1e3,
+                                                                  len(labels) / ms / 1e3))
+        print('  %-28s checksum: %d images, pixel sum %d, label sum %d' % ('notebook loader', len(labels), pixels,
+                                                                         sum(labels)))
+        try:
+            import cv2  # noqa: F401
+        except ImportError:
+            continue
+        start = time.perf_counter()
+        X = preprocess(images)
+        ms = (time.perf_counter() - start) * 1e3
+        print('  %-28s %9.2f ms  %8.3f M images/s' % ('notebook preprocess', ms, len(images) / ms / 1e3))
+        print('  notebook X checksum: %d images, pixel sum %d' % (len(X), int(X.sum(dtype=np.float64))))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,47 @@
+/*
+ * Static work splitting over std::thread
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file parallel.h
+ */
+
+#ifndef HODA_PARALLEL_H
+#define HODA_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace hoda
+{
+
+inline unsigned default_threads()
+{
+  unsigned n = std::thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+/* runs f(begin, end, thread_index) on `threads` contiguous chunks of [0, n), chunk 0 on the
+ * calling thread */
+template <typename F>
+void parallel_for(size_t n, unsigned threads, F&& f)
+{
+  if (threads == 0) threads = default_threads();
+  if (threads <= 1 || n < 2 * size_t(threads)) {
+    f(size_t(0), n, 0u);
+    return;
+  }
+  std::vector<std::thread> pool;
+  size_t chunk = (n + threads - 1) / threads;
+  for (unsigned t = 1; t < threads; t++) {
+    size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+    pool.emplace_back([&f, begin, end, t] { f(begin, end, t); });
+  }
+  f(size_t(0), std::min(n, chunk), 0u);
+  for (std::thread& th : pool) th.join();
+}
+
+} // end namespace
+
+#endif // HODA_PARALLEL_H
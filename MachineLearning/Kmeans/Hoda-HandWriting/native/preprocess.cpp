@@ -0,0 +1,359 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file preprocess.cpp
+ */
+
+#include "preprocess.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HODA_X86 1
+#endif
+
+namespace hoda
+{
+
+const char* to_string(resize_filter filter)
+{
+  return filter == resize_filter::area ? "area" : "cubic";
+}
+
+namespace
+{
+
+const size_t LANES = 16; /* output rows are padded to a multiple of this */
+
+/* std::floor / std::ceil are libm calls without SSE4.1 and make_taps runs for every image */
+inline long floor_long(double v)
+{
+  long i = static_cast<long>(v);
+  return i - (v < i);
+}
+
+inline long ceil_long(double v)
+{
+  long i = static_cast<long>(v);
+  return i + (v > i);
+}
+
+struct tap
+{
+  uint32_t index;
+  float weight;
+};
+
+/* cv2 interpolateCubic, A = -0.75 */
+void cubic_coeffs(float x, float c[4])
+{
+  const float A = -0.75f;
+  c[0] = ((A * (x + 1) - 5 * A) * (x + 1) + 8 * A) * (x + 1) - 4 * A;
+  c[1] = ((A + 2) * x - (A + 3)) * x * x + 1;
+  c[2] = ((A + 2) * (1 - x) - (A + 3)) * (1 - x) * (1 - x) + 1;
+  c[3] = 1.f - c[0] - c[1] - c[2];
+}
+
+/* taps of output sample o are taps[begin[o] .. begin[o + 1]), `in` samples scaled by fx
+ * (cv2's inv_scale) to `out`, with the border replicated */
+void make_taps(resize_filter filter, size_t in, size_t out, double fx, std::vector<tap>& taps,
+               std::vector<uint32_t>& begin)
+{
+  const double scale = 1.0 / fx;
+  taps.clear();
+  begin.assign(out + 1, 0);
+  for (size_t o = 0; o < out; o++) {
+    begin[o] = static_cast<uint32_t>(taps.size());
+    if (filter == resize_filter::cubic) {
+      float f = static_cast<float>((o + 0.5) * scale - 0.5);
+      long s = floor_long(f);
+      float c[4];
+      cubic_coeffs(f - s, c);
+      for (long k = 0; k < 4; k++) {
+        long i = std::min<long>(std::max<long>(s - 1 + k, 0), long(in) - 1);
+        taps.push_back({static_cast<uint32_t>(i), c[k]});
+      }
+    } else {
+      /* cv2 computeResizeAreaTab: source pixels weighted by how much of them the cell covers */
+      double fs1 = o * scale, fs2 = fs1 + scale;
+      double cell = std::min(scale, in - fs1);
+      long s1 = ceil_long(fs1), s2 = floor_long(fs2);
+      s2 = std::min(s2, long(in) - 1);
+      s1 = std::min(s1, s2);
+      if (s1 - fs1 > 1e-3) taps.push_back({static_cast<uint32_t>(s1 - 1), static_cast<float>((s1 - fs1) / cell)});
+      for (long s = s1; s < s2; s++) taps.push_back({static_cast<uint32_t>(s), static_cast<float>(1 / cell)});
+      if (fs2 - s2 > 1e-3)
+        taps.push_back({static_cast<uint32_t>(s2), static_cast<float>(std::min(std::min(fs2 - s2, 1.0), cell) / cell)});
+    }
+  }
+  begin[out] = static_cast<uint32_t>(taps.size());
+}
+
+/* t (h x owp) = img (h x w) * wh (w x owp) */
+using hpass_fn = void (*)(const uint8_t* img, size_t w, size_t h, const float* wh, size_t owp, float* t);
+/* out (oh x owp): row o = sum of weight * row index of t over the taps of o */
+using vpass_fn = void (*)(const float* t, size_t owp, const tap* taps, const uint32_t* begin, size_t oh, float* out);
+
+void hpass_scalar(const uint8_t* img, size_t w, size_t h, const float* wh, size_t owp, float* t)
+{
+  for (size_t y = 0; y < h; y++) {
+    float* row = t + y * owp;
+    std::fill(row, row + owp, 0.0f);
+    for (size_t x = 0; x < w; x++) {
+      float p = img[y * w + x];
+      if (p == 0) continue;
+      const float* wr = wh + x * owp;
+      for (size_t j = 0; j < owp; j++) row[j] += p * wr[j];
+    }
+  }
+}
+
+void vpass_scalar(const float* t, size_t owp, const tap* taps, const uint32_t* begin, size_t oh, float* out)
+{
+  for (size_t o = 0; o < oh; o++) {
+    float* row = out + o * owp;
+    std::fill(row, row + owp, 0.0f);
+    for (uint32_t k = begin[o]; k < begin[o + 1]; k++) {
+      const float* src = t + taps[k].index * owp;
+      for (size_t j = 0; j < owp; j++) row[j] += taps[k].weight * src[j];
+    }
+  }
+}
+
+#ifdef HODA_X86
+
+/* an output row chunk stays in registers while the pixels of the source row are added in,
+ * even and odd pixels in separate accumulators to halve the FMA dependency chain */
+__attribute__((target("avx2,fma"))) void hpass_avx2(const uint8_t* img, size_t w, size_t h, const float* wh,
+                                                    size_t owp, float* t)
+{
+  for (size_t y = 0; y < h; y++) {
+    const uint8_t* src = img + y * w;
+    float* row = t + y * owp;
+    for (size_t j = 0; j < owp; j += 16) {
+      __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), b0 = _mm256_setzero_ps(), b1 = _mm256_setzero_ps();
+      const float* wr = wh + j;
+      size_t x = 0;
+      for (; x + 2 <= w; x += 2, wr += 2 * owp) {
+        __m256 p = _mm256_set1_ps(src[x]), q = _mm256_set1_ps(src[x + 1]);
+        a0 = _mm256_fmadd_ps(p, _mm256_loadu_ps(wr), a0);
+        a1 = _mm256_fmadd_ps(p, _mm256_loadu_ps(wr + 8), a1);
+        b0 = _mm256_fmadd_ps(q, _mm256_loadu_ps(wr + owp), b0);
+        b1 = _mm256_fmadd_ps(q, _mm256_loadu_ps(wr + owp + 8), b1);
+      }
+      if (x < w) {
+        __m256 p = _mm256_set1_ps(src[x]);
+        a0 = _mm256_fmadd_ps(p, _mm256_loadu_ps(wr), a0);
+        a1 = _mm256_fmadd_ps(p, _mm256_loadu_ps(wr + 8), a1);
+      }
+      _mm256_storeu_ps(row + j, _mm256_add_ps(a0, b0));
+      _mm256_storeu_ps(row + j + 8, _mm256_add_ps(a1, b1));
+    }
+  }
+}
+
+__attribute__((target("avx2,fma"))) void vpass_avx2(const float* t, size_t owp, const tap* taps,
+                                                    const uint32_t* begin, size_t oh, float* out)
+{
+  for (size_t o = 0; o < oh; o++) {
+    for (size_t j = 0; j < owp; j += 8) {
+      __m256 acc = _mm256_setzero_ps();
+      for (uint32_t k = begin[o]; k < begin[o + 1]; k++)
+        acc = _mm256_fmadd_ps(_mm256_set1_ps(taps[k].weight), _mm256_loadu_ps(t + taps[k].index * owp + j), acc);
+      _mm256_storeu_ps(out + o * owp + j, acc);
+    }
+  }
+}
+
+/* as hpass_avx2, 32 output columns per chunk and a single register for a last 16 */
+__attribute__((target("avx512f"))) void hpass_avx512(const uint8_t* img, size_t w, size_t h, const float* wh,
+                                                     size_t owp, float* t)
+{
+  for (size_t y = 0; y < h; y++) {
+    const uint8_t* src = img + y * w;
+    float* row = t + y * owp;
+    size_t j = 0;
+    for (; j + 32 <= owp; j += 32) {
+      __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps(), b0 = _mm512_setzero_ps(), b1 = _mm512_setzero_ps();
+      const float* wr = wh + j;
+      size_t x = 0;
+      for (; x + 2 <= w; x += 2, wr += 2 * owp) {
+        __m512 p = _mm512_set1_ps(src[x]), q = _mm512_set1_ps(src[x + 1]);
+        a0 = _mm512_fmadd_ps(p, _mm512_loadu_ps(wr), a0);
+        a1 = _mm512_fmadd_ps(p, _mm512_loadu_ps(wr + 16), a1);
+        b0 = _mm512_fmadd_ps(q, _mm512_loadu_ps(wr + owp), b0);
+        b1 = _mm512_fmadd_ps(q, _mm512_loadu_ps(wr + owp + 16), b1);
+      }
+      if (x < w) {
+        __m512 p = _mm512_set1_ps(src[x]);
+        a0 = _mm512_fmadd_ps(p, _mm512_loadu_ps(wr), a0);
+        a1 = _mm512_fmadd_ps(p, _mm512_loadu_ps(wr + 16), a1);
+      }
+      _mm512_storeu_ps(row + j, _mm512_add_ps(a0, b0));
+      _mm512_storeu_ps(row + j + 16, _mm512_add_ps(a1, b1));
+    }
+    if (j < owp) {
+      __m512 a = _mm512_setzero_ps(), b = _mm512_setzero_ps();
+      const float* wr = wh + j;
+      size_t x = 0;
+      for (; x + 2 <= w; x += 2, wr += 2 * owp) {
+        a = _mm512_fmadd_ps(_mm512_set1_ps(src[x]), _mm512_loadu_ps(wr), a);
+        b = _mm512_fmadd_ps(_mm512_set1_ps(src[x + 1]), _mm512_loadu_ps(wr + owp), b);
+      }
+      if (x < w) a = _mm512_fmadd_ps(_mm512_set1_ps(src[x]), _mm512_loadu_ps(wr), a);
+      _mm512_storeu_ps(row + j, _mm512_add_ps(a, b));
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) void vpass_avx512(const float* t, size_t owp, const tap* taps,
+                                                     const uint32_t* begin, size_t oh, float* out)
+{
+  for (size_t o = 0; o < oh; o++) {
+    for (size_t j = 0; j < owp; j += 16) {
+      __m512 acc = _mm512_setzero_ps();
+      for (uint32_t k = begin[o]; k < begin[o + 1]; k++)
+        acc = _mm512_fmadd_ps(_mm512_set1_ps(taps[k].weight), _mm512_loadu_ps(t + taps[k].index * owp + j), acc);
+      _mm512_storeu_ps(out + o * owp + j, acc);
+    }
+  }
+}
+
+#endif // HODA_X86
+
+struct resize_kernels
+{
+  hpass_fn hpass;
+  vpass_fn vpass;
+};
+
+resize_kernels resize_for(simd_level level)
+{
+#ifdef HODA_X86
+  if (level == simd_level::avx512) return {hpass_avx512, vpass_avx512};
+  if (level == simd_level::avx2) return {hpass_avx2, vpass_avx2};
+#endif
+  (void)level;
+  return {hpass_scalar, vpass_scalar};
+}
+
+/* how images of one size are resized: taps, the dense horizontal matrix and the placement */
+struct plan
+{
+  size_t w = 0, h = 0;
+  size_t ow, oh, owp, y0, x0;
+  std::vector<tap> htaps, vtaps;
+  std::vector<uint32_t> hbegin, vbegin;
+  std::vector<float> wh; /* w x owp */
+};
+
+/* per thread buffers, reused from image to image */
+struct scratch
+{
+  plan p;
+  std::vector<float> t, out;
+  float lut[256]; /* finish() of every uint8 value */
+};
+
+/* the uint8 value cv2 would store (rounded, saturated), normalized and maybe binarized */
+inline float finish(float v, bool binarize)
+{
+  if (binarize) return v >= 127.5f ? 1.0f : 0.0f;
+  return static_cast<float>(static_cast<int>(std::min(std::max(v, 0.0f), 255.0f) + 0.5f)) * (1.0f / 255);
+}
+
+/* finish() over a row, one loop per mode so the compiler vectorizes it */
+void finish_row(const float* src, size_t n, bool binarize, float* dst)
+{
+  if (binarize)
+    for (size_t x = 0; x < n; x++) dst[x] = src[x] >= 127.5f ? 1.0f : 0.0f;
+  else
+    for (size_t x = 0; x < n; x++) dst[x] = finish(src[x], false);
+}
+
+void preprocess_image(const uint8_t* img, size_t w, size_t h, float* dst, const preprocess_options& opt,
+                      const resize_kernels& kern, scratch& s)
+{
+  const size_t H = opt.height, W = opt.width;
+  std::fill(dst, dst + H * W, 0.0f);
+  if (w == 0 || h == 0) return;
+
+  if (h <= H && w <= W) {
+    size_t y0 = (H - h) / 2, x0 = (W - w) / 2;
+    for (size_t y = 0; y < h; y++) {
+      const uint8_t* src = img + y * w;
+      float* row = dst + (y0 + y) * W + x0;
+      for (size_t x = 0; x < w; x++) row[x] = s.lut[src[x]];
+    }
+    return;
+  }
+
+  plan& p = s.p;
+  if (p.w != w || p.h != h) {
+    const double fx = std::min(double(H) / h, double(W) / w);
+    p.w = w;
+    p.h = h;
+    /* cv2 rounds the output size half to even */
+    p.ow = std::max<long>(1, std::lrint(w * fx));
+    p.oh = std::max<long>(1, std::lrint(h * fx));
+    p.owp = (p.ow + LANES - 1) / LANES * LANES;
+    p.y0 = (H - p.oh) / 2;
+    p.x0 = (W - p.ow) / 2;
+    make_taps(opt.filter, w, p.ow, fx, p.htaps, p.hbegin);
+    make_taps(opt.filter, h, p.oh, fx, p.vtaps, p.vbegin);
+    /* the horizontal taps as a dense w x owp matrix */
+    p.wh.assign(w * p.owp, 0.0f);
+    for (size_t o = 0; o < p.ow; o++)
+      for (uint32_t k = p.hbegin[o]; k < p.hbegin[o + 1]; k++) p.wh[p.htaps[k].index * p.owp + o] += p.htaps[k].weight;
+  }
+  s.t.resize(h * p.owp);
+  s.out.resize(p.oh * p.owp);
+
+  kern.hpass(img, w, h, p.wh.data(), p.owp, s.t.data());
+  kern.vpass(s.t.data(), p.owp, p.vtaps.data(), p.vbegin.data(), p.oh, s.out.data());
+  for (size_t y = 0; y < p.oh; y++)
+    finish_row(s.out.data() + y * p.owp, p.ow, opt.binarize, dst + (p.y0 + y) * W + p.x0);
+}
+
+} // end namespace
+
+void preprocess(const cdb_dataset& set, float* out, const preprocess_options& options)
+{
+  simd_level have = detect_simd();
+  simd_level simd = static_cast<int>(options.simd) > static_cast<int>(have) ? have : options.simd;
+  const resize_kernels kern = resize_for(simd);
+  const size_t dim = options.height * options.width;
+  const size_t n = set.size();
+
+  /* images are visited grouped by size, so a thread builds the plan of a size once per run of
+   * images of that size; blocks of that order are handed out to the threads one at a time,
+   * which keeps them busy even though the large images are all at the end */
+  std::vector<uint32_t> order(n);
+  for (size_t i = 0; i < n; i++) order[i] = static_cast<uint32_t>(i);
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    const cdb_record &ra = set.records[a], &rb = set.records[b];
+    return ra.height != rb.height ? ra.height < rb.height : ra.width != rb.width ? ra.width < rb.width : a < b;
+  });
+
+  const size_t BLOCK_IMAGES = 256;
+  std::atomic<size_t> next(0);
+  unsigned threads = options.threads ? options.threads : default_threads();
+  parallel_for(threads, threads, [&](size_t, size_t, unsigned) {
+    scratch s;
+    for (int v = 0; v < 256; v++) s.lut[v] = finish(float(v), options.binarize);
+    for (size_t b; (b = next.fetch_add(BLOCK_IMAGES, std::memory_order_relaxed)) < n;) {
+      for (size_t k = b; k < std::min(n, b + BLOCK_IMAGES); k++) {
+        size_t i = order[k];
+        const cdb_record& r = set.records[i];
+        preprocess_image(set.image(i), r.width, r.height, out + i * dim, options, kern, s);
+      }
+    }
+  });
+}
+
+} // end namespace
@@ -0,0 +1,58 @@
+/*
+ * Resize / pad / normalize of Hoda images to a fixed size, as the notebook prepares X
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file preprocess.h
+ *
+ * For every image, like __resize_image in hoda-kmeans.ipynb:
+ *  1. an image larger than height x width in either direction is scaled down by
+ *     min(height / h, width / w) to round(w * scale) x round(h * scale), with the
+ *     coefficients of cv2.resize (INTER_CUBIC like the notebook, or INTER_AREA),
+ *  2. the result is rounded to 0..255 like cv2's uint8 output, centered on a zero
+ *     background of height x width,
+ *  3. divided by 255 and, with binarize, thresholded at 0.5 to 0 / 1.
+ *
+ * The resize is separable and is done as two small matrix products, out = Wv * img * Wh:
+ * the horizontal pass broadcasts each pixel and multiply-adds it into the whole output row
+ * (the row of Wh for that column, padded to 16 floats), the vertical pass adds up the few
+ * rows of its taps. Both run along the output row with AVX2 / AVX-512 (picked at run time
+ * like the distance kernels), and images are split over threads. The scalar pass skips
+ * zero pixels; the SIMD passes use every pixel, their output row chunk stays in registers
+ * and a branch per pixel would cost more than the multiply-adds it saves.
+ */
+
+#ifndef HODA_PREPROCESS_H
+#define HODA_PREPROCESS_H
+
+#include "cdb_reader.h"
+#include "distance.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hoda
+{
+
+enum class resize_filter : uint8_t
+{
+  cubic = 0, /* cv2.INTER_CUBIC, what the notebook uses */
+  area = 1   /* cv2.INTER_AREA */
+};
+
+const char* to_string(resize_filter filter);
+
+struct preprocess_options
+{
+  size_t height = 32, width = 32;
+  resize_filter filter = resize_filter::cubic;
+  bool binarize = true;
+  unsigned threads = 0; /* 0: one per core */
+  simd_level simd = detect_simd();
+};
+
+/* all images of set into out, set.size() x height x width floats */
+void preprocess(const cdb_dataset& set, float* out, const preprocess_options& options = preprocess_options());
+
+} // end namespace
+
+#endif // HODA_PREPROCESS_H
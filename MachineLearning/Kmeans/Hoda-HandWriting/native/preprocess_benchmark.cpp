@@ -0,0 +1,130 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file preprocess_benchmark.cpp
+ * @discription resize / pad / normalize of the Hoda images to 32x32 per filter and SIMD level,
+ *              thread scaling, and opening the tensor cache cold (decode + preprocess + write)
+ *              against warm (hash + mmap). Prints the same checksum as notebook_loader.py.
+ *              usage: preprocess_benchmark [threads] [cache dir] [file ...]
+ *              (default: one thread per core, ./hoda_cache, ../dataset/Test_20000.cdb ../dataset/RemainingSamples.cdb)
+ */
+
+#include "cdb_reader.h"
+#include "parallel.h"
+#include "preprocess.h"
+#include "tensor_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using clock_type = std::chrono::steady_clock;
+
+double ms_since(clock_type::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+bool run(const std::string& path, const std::string& cache_dir, unsigned max_threads)
+{
+  std::printf("%s\n", path.c_str());
+  auto start = clock_type::now();
+  hoda::cdb_dataset set = hoda::load_cdb(path, max_threads);
+  std::printf("  load_cdb: %.2f ms, %zu images\n", ms_since(start), set.size());
+
+  hoda::preprocess_options opt;
+  opt.threads = max_threads;
+  const size_t dim = opt.height * opt.width;
+  std::vector<float> reference(set.size() * dim), x(set.size() * dim);
+
+  for (hoda::resize_filter filter : {hoda::resize_filter::cubic, hoda::resize_filter::area}) {
+    opt.filter = filter;
+    for (int level = 0; level <= static_cast<int>(hoda::detect_simd()); level++) {
+      opt.simd = static_cast<hoda::simd_level>(level);
+      std::vector<float>& out = level ? x : reference;
+      double best = 1e30;
+      for (int rep = 0; rep < 5; rep++) {
+        start = clock_type::now();
+        hoda::preprocess(set, out.data(), opt);
+        best = std::min(best, ms_since(start));
+      }
+      size_t differ = 0;
+      if (level)
+        for (size_t i = 0; i < out.size(); i++) differ += out[i] != reference[i];
+      std::printf("  %-5s %-8s %8.2f ms  %8.2f M images/s  (%zu pixels differ from scalar)\n",
+                  hoda::to_string(filter), hoda::to_string(opt.simd), best, set.size() / best / 1e3, differ);
+      if (differ > out.size() / 10000) return false;
+    }
+    if (filter == hoda::resize_filter::cubic) {
+      double ones = 0;
+      for (float v : reference) ones += v;
+      std::printf("  notebook X checksum: %zu images, pixel sum %.0f\n", set.size(), ones);
+    }
+  }
+
+  /* thread scaling, cubic, widest SIMD */
+  opt = hoda::preprocess_options();
+  std::vector<unsigned> counts;
+  for (unsigned threads = 1; threads < max_threads; threads *= 2) counts.push_back(threads);
+  counts.push_back(max_threads);
+  double base = 0;
+  for (unsigned threads : counts) {
+    opt.threads = threads;
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+      start = clock_type::now();
+      hoda::preprocess(set, x.data(), opt);
+      best = std::min(best, ms_since(start));
+    }
+    if (threads == 1) base = best;
+    std::printf("  cubic, %2u threads: %8.2f ms (x%.1f)\n", threads, best, base / best);
+  }
+
+  /* cache: build it from scratch, then map it again */
+  opt.threads = max_threads;
+  std::string cached = hoda::open_preprocessed(path, cache_dir, opt).path();
+  std::remove(cached.c_str());
+  start = clock_type::now();
+  hoda::tensor_file cold = hoda::open_preprocessed(path, cache_dir, opt);
+  double cold_ms = ms_since(start);
+  start = clock_type::now();
+  hoda::tensor_file warm = hoda::open_preprocessed(path, cache_dir, opt);
+  double warm_ms = ms_since(start);
+  hoda::preprocess(set, x.data(), opt);
+  bool same = !warm.built() && warm.size() == set.size() &&
+              std::memcmp(warm.data(), x.data(), x.size() * sizeof(float)) == 0 &&
+              std::memcmp(warm.labels(), set.labels.data(), set.size()) == 0;
+  std::printf("  cache %s: cold %.2f ms (built: %s), warm %.2f ms (built: %s), %s\n", warm.path().c_str(), cold_ms,
+              cold.built() ? "yes" : "no", warm_ms, warm.built() ? "yes" : "no",
+              same ? "same tensor" : "DIFFERENT tensor");
+  return same;
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  unsigned threads = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 0;
+  if (threads == 0) threads = hoda::default_threads();
+  std::string cache_dir = argc > 2 ? argv[2] : "hoda_cache";
+  std::vector<std::string> files(argv + std::min(argc, 3), argv + argc);
+  if (files.empty()) files = {"../dataset/Test_20000.cdb", "../dataset/RemainingSamples.cdb"};
+
+  try {
+    for (const std::string& f : files)
+      if (!run(f, cache_dir, threads)) return 1;
+  } catch (const std::exception& e) {
+    std::printf("%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
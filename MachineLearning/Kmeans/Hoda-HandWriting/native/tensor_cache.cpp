@@ -0,0 +1,155 @@
+/*
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file tensor_cache.cpp
+ */
+
+#include "tensor_cache.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hoda
+{
+
+namespace
+{
+
+const char MAGIC[8] = {'H', 'O', 'D', 'A', 'T', 'N', 'S', 'R'};
+
+inline uint64_t mix(uint64_t h, uint64_t v)
+{
+  h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+  h *= 0xFF51AFD7ED558CCDull;
+  return h ^ (h >> 32);
+}
+
+/* 64 bit hash of a byte range, 8 bytes per step */
+uint64_t hash_bytes(const uint8_t* p, size_t n, uint64_t h)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t v;
+    std::memcpy(&v, p + i, 8);
+    h = mix(h, v);
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, p + i, n - i);
+  return mix(mix(h, tail), n);
+}
+
+uint64_t key_of(const mapped_file& source, const preprocess_options& options)
+{
+  uint64_t h = mix(0, TENSOR_CACHE_VERSION);
+  h = hash_bytes(source.data(), source.size(), h);
+  h = mix(h, options.height);
+  h = mix(h, options.width);
+  h = mix(h, static_cast<uint64_t>(options.filter));
+  return mix(h, options.binarize);
+}
+
+std::string cache_path(const std::string& cdb_path, const std::string& cache_dir, uint64_t key)
+{
+  std::string name = cdb_path.substr(cdb_path.find_last_of('/') + 1);
+  name = name.substr(0, name.find_last_of('.'));
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+  return (cache_dir.empty() ? std::string(".") : cache_dir) + "/" + name + "-" + hex + ".tensor";
+}
+
+bool matches(const tensor_header& h, size_t file_size, uint64_t key, const preprocess_options& options)
+{
+  size_t dim = size_t(h.height) * h.width;
+  return std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 && h.version == TENSOR_CACHE_VERSION &&
+         h.header_size == sizeof(tensor_header) && h.key == key && h.height == options.height &&
+         h.width == options.width && h.filter == static_cast<uint8_t>(options.filter) &&
+         h.binarize == uint8_t(options.binarize) && h.labels_offset == sizeof(tensor_header) + h.count * dim * sizeof(float) &&
+         file_size == h.labels_offset + h.count;
+}
+
+void write_all(FILE* f, const void* p, size_t n, const std::string& path)
+{
+  if (std::fwrite(p, 1, n, f) != n) throw std::system_error(errno, std::generic_category(), "write " + path);
+}
+
+void build(const std::string& cdb_path, const std::string& path, uint64_t key, const preprocess_options& options)
+{
+  cdb_dataset set = load_cdb(cdb_path, options.threads);
+  size_t dim = options.height * options.width;
+  std::vector<float> x(set.size() * dim);
+  preprocess(set, x.data(), options);
+
+  tensor_header h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version = TENSOR_CACHE_VERSION;
+  h.header_size = sizeof(tensor_header);
+  h.key = key;
+  h.count = set.size();
+  h.height = static_cast<uint32_t>(options.height);
+  h.width = static_cast<uint32_t>(options.width);
+  h.filter = static_cast<uint8_t>(options.filter);
+  h.binarize = options.binarize;
+  h.labels_offset = sizeof(tensor_header) + x.size() * sizeof(float);
+
+  std::string tmp = path + ".tmp." + std::to_string(::getpid());
+  FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) throw std::system_error(errno, std::generic_category(), "create " + tmp);
+  try {
+    write_all(f, &h, sizeof(h), tmp);
+    write_all(f, x.data(), x.size() * sizeof(float), tmp);
+    write_all(f, set.labels.data(), set.labels.size(), tmp);
+  } catch (...) {
+    std::fclose(f);
+    std::remove(tmp.c_str());
+    throw;
+  }
+  if (std::fclose(f) != 0 || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    int err = errno;
+    std::remove(tmp.c_str());
+    throw std::system_error(err, std::generic_category(), "write " + path);
+  }
+}
+
+} // end namespace
+
+uint64_t tensor_cache_key(const std::string& cdb_path, const preprocess_options& options)
+{
+  mapped_file source(cdb_path);
+  return key_of(source, options);
+}
+
+tensor_file open_preprocessed(const std::string& cdb_path, const std::string& cache_dir,
+                              const preprocess_options& options)
+{
+  uint64_t key = tensor_cache_key(cdb_path, options);
+  tensor_file t;
+  t.path_ = cache_path(cdb_path, cache_dir, key);
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (::access(t.path_.c_str(), R_OK) == 0) {
+      t.file_.reset(new mapped_file(t.path_));
+      if (t.file_->size() >= sizeof(tensor_header)) {
+        std::memcpy(&t.header_, t.file_->data(), sizeof(tensor_header));
+        if (matches(t.header_, t.file_->size(), key, options)) return t;
+      }
+      t.file_.reset();
+    }
+    if (attempt == 0) {
+      if (!cache_dir.empty() && ::mkdir(cache_dir.c_str(), 0777) != 0 && errno != EEXIST)
+        throw std::system_error(errno, std::generic_category(), "mkdir " + cache_dir);
+      build(cdb_path, t.path_, key, options);
+      t.built_ = true;
+    }
+  }
+  throw std::runtime_error("tensor cache: " + t.path_ + " does not match after rebuilding it");
+}
+
+} // end namespace
@@ -0,0 +1,91 @@
+/*
+ * Memory-mapped cache of preprocessed Hoda tensors
+ * @author Over-Infinity
+ * @date October 19, 2026
+ * @file tensor_cache.h
+ *
+ * open_preprocessed() returns the images of a .cdb file preprocessed with the given options
+ * (see preprocess.h), mapped read-only from a cache file. The first call decodes and
+ * preprocesses the .cdb and writes the cache; later calls only hash the source and map the
+ * cache, a few milliseconds instead of a decode + resize.
+ *
+ * Cache file, <cache_dir>/<source name>-<key as 16 hex digits>.tensor:
+ *
+ *   tensor_header (64 bytes) | count * height * width float32 | count uint8 labels
+ *
+ * The key is a hash of TENSOR_CACHE_VERSION, the contents of the .cdb file and the options
+ * that change the output (size, filter, binarize). Threads and SIMD level are not part of
+ * it. A changed source or other options give another key and so another file. Bump the
+ * version when preprocessing changes, so older caches are no longer used. A cache whose
+ * header does not match its name, options and file size is rebuilt. A new cache is written
+ * to a temporary file and renamed into place, so a reader never maps a half-written one.
+ */
+
+#ifndef HODA_TENSOR_CACHE_H
+#define HODA_TENSOR_CACHE_H
+
+#include "cdb_reader.h"
+#include "preprocess.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace hoda
+{
+
+const uint32_t TENSOR_CACHE_VERSION = 1;
+
+struct tensor_header
+{
+  char magic[8]; /* "HODATNSR" */
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t key;
+  uint64_t count;
+  uint32_t height, width;
+  uint8_t filter, binarize;
+  uint8_t reserved[6];
+  uint64_t labels_offset;
+  uint64_t reserved2;
+};
+
+static_assert(sizeof(tensor_header) == 64, "tensor_header is 64 bytes on disk");
+
+/* a preprocessed dataset, mapped from its cache file */
+class tensor_file
+{
+public:
+  size_t size() const { return header_.count; }
+  size_t height() const { return header_.height; }
+  size_t width() const { return header_.width; }
+  size_t dim() const { return size_t(header_.height) * header_.width; }
+  const float* data() const { return reinterpret_cast<const float*>(file_->data() + sizeof(tensor_header)); }
+  const float* image(size_t i) const { return data() + i * dim(); }
+  const uint8_t* labels() const { return file_->data() + header_.labels_offset; }
+
+  const std::string& path() const { return path_; }
+  /* true when this call had to build the cache */
+  bool built() const { return built_; }
+
+private:
+  friend tensor_file open_preprocessed(const std::string&, const std::string&, const preprocess_options&);
+
+  std::unique_ptr<mapped_file> file_;
+  tensor_header header_;
+  std::string path_;
+  bool built_ = false;
+};
+
+/* cache key of cdb_path preprocessed with options */
+uint64_t tensor_cache_key(const std::string& cdb_path, const preprocess_options& options);
+
+/* maps the cached tensor of cdb_path, building it first when there is none (cache_dir is
+ * created when missing); throws std::runtime_error / std::system_error */
+tensor_file open_preprocessed(const std::string& cdb_path, const std::string& cache_dir,
+                              const preprocess_options& options = preprocess_options());
+
+} // end namespace
+
+#endif // HODA_TENSOR_CACHE_H
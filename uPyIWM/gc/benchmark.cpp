@@ -0,0 +1,193 @@
+/*
+ * this file is a part of uPyIWM project, https://github.com/over-infinity/-Tutorials/uPyIWM
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* benchmark.cpp */
+
+/***********************************************************************************
+ alloc / free latency and GC pause time against heap size.
+
+ For every heap size a live object graph (objects of 32..256 bytes that point at each
+ other, hanging off a root array) is built with as much garbage in between, so that
+ after the first collection the free space is fragmented. Then:
+   - alloc: random 16..256 byte allocations until the heap is ~80% used (no collection)
+   - free:  the same objects freed in random order
+   - gc:    the heap is filled with garbage and collected
+ Every object stores a magic value; after each collection the graph is walked from the
+ roots and checked, the program exits with 1 when an object was lost or damaged.
+
+ usage: gc_benchmark [max heap MB] (default 64)
+************************************************************************************/
+
+#include "gc_heap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+static const uint64_t MAGIC = 0x9E3779B97F4A7C15ull;
+static const size_t NUM_ROOTS = 1024;
+
+struct Obj{
+   uint64_t magic;            /* MAGIC ^ id */
+   uint64_t id;
+   uint32_t num_children;
+   uint32_t capacity;
+   Obj* children[1];          /* capacity entries */
+};
+
+static const size_t OBJ_HEADER = offsetof(Obj, children);
+
+static double Percentile(std::vector<double>& v, double p){
+   if(v.empty()) return 0;
+   size_t k = static_cast<size_t>(p * (v.size() - 1));
+   std::nth_element(v.begin(), v.begin() + k, v.end());
+   return v[k];
+}
+
+static Obj* NewObj(GcHeap& heap, size_t bytes, uint64_t id){
+   Obj* o = static_cast<Obj*>(heap.Alloc(bytes, false));
+   if(!o) return nullptr;
+   o->magic = MAGIC ^ id;
+   o->id = id;
+   o->num_children = 0;
+   o->capacity = static_cast<uint32_t>((bytes - OBJ_HEADER) / sizeof(Obj*));
+   return o;
+}
+
+/* walks the graph from the roots, returns the number of objects or 0 when one is damaged */
+static size_t Verify(const GcHeap& heap, const std::vector<void*>& roots){
+   std::vector<const Obj*> stack;
+   for(void* r : roots) if(r) stack.push_back(static_cast<const Obj*>(r));
+   size_t count = 0;
+   while(!stack.empty()){
+      const Obj* o = stack.back();
+      stack.pop_back();
+      if(o->magic != (MAGIC ^ o->id) || heap.NBytes(o) < OBJ_HEADER + o->capacity * sizeof(Obj*)) return 0;
+      count++;
+      for(uint32_t i = 0; i < o->num_children; i++) stack.push_back(o->children[i]);
+   }
+   return count;
+}
+
+static bool Run(size_t heap_bytes){
+   std::unique_ptr<unsigned char[]> memory(new unsigned char[heap_bytes]);
+   GcHeap heap(memory.get(), memory.get() + heap_bytes, 4096);
+   std::vector<void*> roots(NUM_ROOTS, nullptr);
+   heap.AddRoot(roots.data(), roots.size());
+   std::mt19937_64 rng(heap_bytes);
+
+   /* live graph, each object linked exactly once, with garbage in between */
+   std::vector<Obj*> live;
+   uint64_t next_id = 0;
+   size_t free_roots = NUM_ROOTS;
+   size_t used = 0, half = heap.GetInfo().total / 2;
+   while(used < half){
+      Obj* o = NewObj(heap, 32 + rng() % 225, next_id++);
+      if(!o) break;
+      used += heap.NBytes(o);
+      Obj* parent = live.empty() ? nullptr : live[rng() % live.size()];
+      if(parent && parent->num_children < parent->capacity && (free_roots == 0 || rng() % 16)){
+         parent->children[parent->num_children++] = o;
+      }else if(free_roots){
+         roots[NUM_ROOTS - free_roots--] = o;
+      }else{
+         continue;                             /* nowhere to hang it: garbage */
+      }
+      live.push_back(o);
+      Obj* garbage = NewObj(heap, 32 + rng() % 225, next_id++);
+      if(!garbage) break;
+      used += heap.NBytes(garbage);
+   }
+
+   auto start = clock_type::now();
+   heap.Collect();
+   double first_gc = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+   if(Verify(heap, roots) != live.size() || heap.GetInfo().num_objects != live.size()){
+      std::printf("heap %zu: live objects lost after collection\n", heap_bytes);
+      return false;
+   }
+
+   /* alloc latency on the fragmented heap */
+   std::vector<void*> extra;
+   std::vector<double> alloc_ns, free_ns;
+   size_t target = heap.GetInfo().total / 10 * 8;
+   used = heap.GetInfo().used;
+   while(used < target){
+      size_t bytes = 16 + rng() % 241;
+      auto t0 = clock_type::now();
+      void* p = heap.Alloc(bytes, false);
+      auto t1 = clock_type::now();
+      if(!p) break;
+      alloc_ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+      extra.push_back(p);
+      used += heap.NBytes(p);
+   }
+
+   /* free latency, random order */
+   std::shuffle(extra.begin(), extra.end(), rng);
+   for(void* p : extra){
+      auto t0 = clock_type::now();
+      heap.Free(p);
+      auto t1 = clock_type::now();
+      free_ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+   }
+
+   /* GC pause with the pool full of garbage */
+   while(NewObj(heap, 32 + rng() % 225, next_id++)){}
+   start = clock_type::now();
+   heap.Collect();
+   double full_gc = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+   if(Verify(heap, roots) != live.size() || heap.GetInfo().num_objects != live.size()){
+      std::printf("heap %zu: live objects lost after collection\n", heap_bytes);
+      return false;
+   }
+
+   double alloc_mean = 0, free_mean = 0;
+   for(double v : alloc_ns) alloc_mean += v;
+   for(double v : free_ns) free_mean += v;
+   alloc_mean /= alloc_ns.empty() ? 1 : alloc_ns.size();
+   free_mean /= free_ns.empty() ? 1 : free_ns.size();
+   std::printf("%8zu KB %9zu %8zu %7.0f %7.0f %7.0f %7.0f %7.0f %7.0f %9.3f %9.3f\n", heap_bytes / 1024,
+               live.size(), alloc_ns.size(), alloc_mean, Percentile(alloc_ns, 0.5), Percentile(alloc_ns, 0.99),
+               free_mean, Percentile(free_ns, 0.5), Percentile(free_ns, 0.99), first_gc, full_gc);
+   return true;
+}
+
+int main(int argc, char* argv[]){
+   size_t max_mb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+   std::printf("latency in ns (includes ~20 ns of clock reads), gc pause in ms\n");
+   std::printf("%11s %9s %8s %7s %7s %7s %7s %7s %7s %9s %9s\n", "heap", "live", "allocs", "a.mean", "a.p50",
+               "a.p99", "f.mean", "f.p50", "f.p99", "gc(50%)", "gc(full)");
+   for(size_t kb = 64; kb <= max_mb * 1024; kb *= 4)
+      if(!Run(kb * 1024)) return 1;
+   return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * this file is a part of uPyIWM project, https://github.com/over-infinity/-Tutorials/uPyIWM
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* example.cpp */
+
+/***********************************************************************************
+ A small object graph on a 4 KB heap: a linked list hanging off a root keeps its nodes
+ alive, everything else is garbage at the next collection.
+************************************************************************************/
+
+#include "gc_heap.h"
+
+#include <cstdio>
+
+struct Node{
+   Node* next;
+   long value;
+};
+
+static void PrintInfo(const char* when, const GcHeap& heap){
+   GcHeap::Info info = heap.GetInfo();
+   std::printf("%-24s used %5zu / %zu bytes, %3zu objects, longest free run %zu blocks\n",
+               when, info.used, info.total, info.num_objects, info.max_free);
+}
+
+int main(){
+   alignas(16) static unsigned char memory[4096];
+   GcHeap heap(memory, memory + sizeof(memory));
+   std::printf("ATB %zu bytes, pool %zu blocks at offset %zu\n", heap.gc_alloc_table_byte_len(),
+               heap.gc_pool_block_len(), size_t(heap.gc_pool_start() - memory));
+
+   void* root = nullptr;
+   heap.AddRoot(&root, 1);
+
+   Node* head = nullptr;
+   for(long i = 0; i < 10; i++){
+      Node* n = static_cast<Node*>(heap.Alloc(sizeof(Node)));
+      n->next = head;
+      n->value = i;
+      head = n;
+      heap.Alloc(48);                  /* garbage, nothing points at it */
+   }
+   root = head;
+   head = nullptr;
+   PrintInfo("before collect:", heap);
+
+   heap.Collect();
+   PrintInfo("after collect:", heap);
+
+   long sum = 0;
+   for(Node* n = static_cast<Node*>(root); n; n = n->next) sum += n->value;
+   std::printf("list still reachable, sum = %ld\n", sum);
+
+   root = nullptr;
+   heap.Collect();
+   PrintInfo("root cleared, collect:", heap);
+   return 0;
+}
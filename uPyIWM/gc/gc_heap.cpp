@@ -0,0 +1,317 @@
+/*
+ * this file is a part of uPyIWM project, https://github.com/over-infinity/-Tutorials/uPyIWM
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* gc_heap.cpp */
+#include "gc_heap.h"
+
+#include <cstring>
+#include <stdexcept>
+
+static const size_t NO_BLOCK = ~size_t(0);
+static const size_t BLOCKS_PER_WORD = 32;           /* one 64 bit ATB word */
+
+GcHeap::GcHeap(void* heap_start, void* heap_end, size_t mark_stack_size):free_hint(),collections(0),mark_stack(mark_stack_size ? mark_stack_size : 1),mark_sp(0),mark_overflow(false){
+   uintptr_t start = reinterpret_cast<uintptr_t>(heap_start);
+   uintptr_t end = reinterpret_cast<uintptr_t>(heap_end) & ~uintptr_t(BYTES_PER_BLOCK - 1);
+   if(end <= start) throw std::invalid_argument("GcHeap: empty heap");
+
+   size_t total_byte_len = end - start;
+   atb = reinterpret_cast<uint8_t*>(start);
+   atb_len = total_byte_len / (1 + BITS_PER_BYTE / 2 * BYTES_PER_BLOCK);
+   pool_blocks = atb_len * BLOCKS_PER_ATB;
+   pool_end = reinterpret_cast<uint8_t*>(end);
+   pool_start = pool_end - pool_blocks * BYTES_PER_BLOCK;
+   if(atb_len == 0) throw std::invalid_argument("GcHeap: heap too small");
+
+   std::memset(atb, 0, atb_len);
+}
+
+/***********************************************************************************
+ Allocation table access
+************************************************************************************/
+GcHeap::BlockState GcHeap::GetState(size_t block) const{
+   return static_cast<BlockState>((atb[block / BLOCKS_PER_ATB] >> (2 * (block % BLOCKS_PER_ATB))) & 3);
+}
+
+void GcHeap::SetState(size_t block, BlockState state){
+   uint8_t& byte = atb[block / BLOCKS_PER_ATB];
+   unsigned shift = 2 * (block % BLOCKS_PER_ATB);
+   byte = static_cast<uint8_t>((byte & ~(3u << shift)) | (unsigned(state) << shift));
+}
+
+/* sets n blocks from block on, whole ATB bytes at a time in the middle */
+void GcHeap::SetRange(size_t block, size_t n, BlockState state){
+   size_t end = block + n;
+   while(block < end && block % BLOCKS_PER_ATB)
+      SetState(block++, state);
+   size_t bytes = (end - block) / BLOCKS_PER_ATB;
+   if(bytes){
+      std::memset(atb + block / BLOCKS_PER_ATB, state * 0x55, bytes);
+      block += bytes * BLOCKS_PER_ATB;
+   }
+   while(block < end)
+      SetState(block++, state);
+}
+
+/* 8 ATB bytes (32 blocks) as one word, bytes past the end of the table read as used */
+uint64_t GcHeap::LoadAtbWord(size_t word) const{
+   size_t offset = word * 8;
+   uint64_t w;
+   if(offset + 8 <= atb_len){
+      std::memcpy(&w, atb + offset, 8);
+   }else{
+      uint8_t tmp[8];
+      std::memset(tmp, 0x55, 8);
+      std::memcpy(tmp, atb + offset, atb_len - offset);
+      std::memcpy(&w, tmp, 8);
+   }
+   return w;
+}
+
+/* bit i of the result is set when block i of the word is FREE (both of its ATB bits 0) */
+uint32_t GcHeap::FreeMask(uint64_t atb_word){
+   uint64_t x = ~(atb_word | (atb_word >> 1)) & 0x5555555555555555ull;
+   /* compress the even bits into the low 32 bits */
+   x = (x | (x >> 1)) & 0x3333333333333333ull;
+   x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+   x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+   x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+   x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+   return static_cast<uint32_t>(x);
+}
+
+/***********************************************************************************
+ Finding n free blocks, 32 blocks per step:
+  - a run that reached the top of the previous word continues with the trailing free
+    blocks of this one (count trailing ones).
+  - inside one word, r &= r >> k with k doubling leaves bit i set only if blocks i..i+n-1
+    are all free, so log2(n) and/shift steps test all 32 start positions at once.
+  - the free blocks at the top of the word (count leading ones) start the next run.
+************************************************************************************/
+size_t GcHeap::FindFreeRun(size_t n, size_t from) const{
+   size_t words = (atb_len + 7) / 8;
+   size_t run = 0, run_start = 0;
+   for(size_t w = from / BLOCKS_PER_WORD; w < words; w++){
+      uint32_t m = FreeMask(LoadAtbWord(w));
+      if(run){
+         if(m == 0xFFFFFFFFu){
+            run += BLOCKS_PER_WORD;
+            if(run >= n) return run_start;
+            continue;
+         }
+         if(run + __builtin_ctz(~m) >= n) return run_start;
+         run = 0;
+      }
+      if(n <= BLOCKS_PER_WORD){
+         uint32_t r = m;
+         for(size_t len = 1; len < n && r;){
+            size_t step = len < n - len ? len : n - len;
+            r &= r >> step;
+            len += step;
+         }
+         if(r) return w * BLOCKS_PER_WORD + __builtin_ctz(r);
+      }else if(m == 0xFFFFFFFFu){
+         run = BLOCKS_PER_WORD;
+         run_start = w * BLOCKS_PER_WORD;
+         continue;
+      }
+      if(m & 0x80000000u){
+         run = __builtin_clz(~m);
+         run_start = (w + 1) * BLOCKS_PER_WORD - run;
+      }
+   }
+   return NO_BLOCK;
+}
+
+/* a run of n free blocks that now contains block starts at block - (n - 1) or later: the
+   free blocks in front of block were a run shorter than n, or the hint was already lower */
+void GcHeap::Freed(size_t block){
+   for(size_t i = 0; i < FREE_HINTS; i++){
+      size_t start = block > i ? block - i : 0;
+      if(start < free_hint[i]) free_hint[i] = start;
+   }
+}
+
+size_t GcHeap::BlockOf(const void* ptr) const{
+   return (static_cast<const uint8_t*>(ptr) - pool_start) / BYTES_PER_BLOCK;
+}
+
+/* a word is a pointer to an object when it points at the first byte of a block */
+bool GcHeap::VerifyPtr(const void* ptr) const{
+   const uint8_t* p = static_cast<const uint8_t*>(ptr);
+   return p >= pool_start && p < pool_end && (p - pool_start) % BYTES_PER_BLOCK == 0;
+}
+
+/* length in blocks of the object starting at head (HEAD or MARK) */
+size_t GcHeap::ObjectBlocks(size_t head) const{
+   size_t b = head + 1;
+   while(b < pool_blocks && GetState(b) == AT_TAIL) b++;
+   return b - head;
+}
+
+/***********************************************************************************
+ Allocation
+************************************************************************************/
+void* GcHeap::Alloc(size_t n_bytes, bool allow_collect){
+   if(n_bytes == 0) return nullptr;
+   size_t n_blocks = (n_bytes + BYTES_PER_BLOCK - 1) / BYTES_PER_BLOCK;
+   size_t& hint = free_hint[(n_blocks < FREE_HINTS ? n_blocks : FREE_HINTS) - 1];
+   size_t block = FindFreeRun(n_blocks, hint);
+   if(block == NO_BLOCK && allow_collect){
+      Collect();
+      block = FindFreeRun(n_blocks, hint);
+   }
+   if(block == NO_BLOCK){
+      if(n_blocks <= FREE_HINTS) hint = pool_blocks;
+      return nullptr;
+   }
+
+   SetState(block, AT_HEAD);
+   SetRange(block + 1, n_blocks - 1, AT_TAIL);
+   /* allocating only ever moves the hints up, no need to lower any of them */
+   if(n_blocks <= FREE_HINTS) hint = block + n_blocks;
+
+   uint8_t* p = pool_start + block * BYTES_PER_BLOCK;
+   std::memset(p, 0, n_blocks * BYTES_PER_BLOCK);
+   return p;
+}
+
+void GcHeap::Free(void* ptr){
+   if(!ptr || !VerifyPtr(ptr)) return;
+   size_t block = BlockOf(ptr);
+   if(GetState(block) != AT_HEAD) return;
+   SetRange(block, ObjectBlocks(block), AT_FREE);
+   Freed(block);
+}
+
+size_t GcHeap::NBytes(const void* ptr) const{
+   if(!ptr || !VerifyPtr(ptr)) return 0;
+   size_t block = BlockOf(ptr);
+   BlockState s = GetState(block);
+   if(s != AT_HEAD && s != AT_MARK) return 0;
+   return ObjectBlocks(block) * BYTES_PER_BLOCK;
+}
+
+/***********************************************************************************
+ Mark & sweep
+************************************************************************************/
+void GcHeap::AddRoot(void* const* begin, size_t count){
+   roots.push_back({begin, count});
+}
+
+void GcHeap::ClearRoots(){
+   roots.clear();
+}
+
+void GcHeap::MarkPtr(const void* ptr){
+   if(!VerifyPtr(ptr)) return;
+   size_t block = BlockOf(ptr);
+   if(GetState(block) != AT_HEAD) return;
+   SetState(block, AT_MARK);
+   if(mark_sp < mark_stack.size())
+      mark_stack[mark_sp++] = block;
+   else
+      mark_overflow = true;   /* marked, but its children are scanned later */
+}
+
+void GcHeap::ScanObject(size_t head){
+   size_t n = ObjectBlocks(head) * BYTES_PER_BLOCK / sizeof(void*);
+   void* const* words = reinterpret_cast<void* const*>(pool_start + head * BYTES_PER_BLOCK);
+   for(size_t i = 0; i < n; i++) MarkPtr(words[i]);
+}
+
+void GcHeap::MarkDrain(){
+   while(mark_sp > 0) ScanObject(mark_stack[--mark_sp]);
+}
+
+void GcHeap::Sweep(){
+   size_t first_freed = NO_BLOCK;
+   bool free_tail = false;
+   for(size_t i = 0; i < atb_len; i++){
+      uint8_t byte = atb[i];
+      if(byte == 0){ free_tail = false; continue; }
+      for(unsigned k = 0; k < BLOCKS_PER_ATB; k++){
+         unsigned shift = 2 * k;
+         switch((byte >> shift) & 3){
+         case AT_HEAD:                    /* not reached: free it with its tail */
+            byte &= ~(3u << shift);
+            free_tail = true;
+            if(first_freed == NO_BLOCK) first_freed = i * BLOCKS_PER_ATB + k;
+            break;
+         case AT_MARK:                    /* reached: back to HEAD for the next cycle */
+            byte &= ~(2u << shift);
+            free_tail = false;
+            break;
+         case AT_TAIL:
+            if(free_tail) byte &= ~(3u << shift);
+            break;
+         default:
+            free_tail = false;
+            break;
+         }
+      }
+      atb[i] = byte;
+   }
+   if(first_freed != NO_BLOCK) Freed(first_freed);
+}
+
+void GcHeap::Collect(){
+   mark_sp = 0;
+   mark_overflow = false;
+   for(const Root& r : roots)
+      for(size_t i = 0; i < r.count; i++){
+         MarkPtr(r.begin[i]);
+         MarkDrain();
+      }
+   /* the stack overflowed: scan every marked object again until nothing new is found */
+   while(mark_overflow){
+      mark_overflow = false;
+      for(size_t b = 0; b < pool_blocks; b++)
+         if(GetState(b) == AT_MARK){
+            ScanObject(b);
+            MarkDrain();
+         }
+   }
+   Sweep();
+   collections++;
+}
+
+GcHeap::Info GcHeap::GetInfo() const{
+   Info info = {pool_blocks * BYTES_PER_BLOCK, 0, 0, 0, 0};
+   size_t run = 0;
+   for(size_t b = 0; b < pool_blocks; b++){
+      BlockState s = GetState(b);
+      if(s == AT_FREE){
+         if(++run > info.max_free) info.max_free = run;
+         continue;
+      }
+      run = 0;
+      info.used += BYTES_PER_BLOCK;
+      if(s == AT_HEAD || s == AT_MARK) info.num_objects++;
+   }
+   info.free = info.total - info.used;
+   return info;
+}
@@ -0,0 +1,145 @@
+/*
+ * this file is a part of uPyIWM project, https://github.com/over-infinity/-Tutorials/uPyIWM
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021, Over-Infinity
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* gc_heap.h */
+
+/***********************************************************************************
+ MicroPython style block heap (see diagrams/heap_layout.drawio)
+
+   Heap Start                                                              Heap End
+   | ATB (gc_alloc_table_byte_len) | (unused) | Pool: Block 0 ... Block n       |
+                                              ^ gc_pool_start                   ^ gc_pool_end
+
+   total_byte_len          = Heap_End - Heap_Start
+   gc_alloc_table_byte_len = total_byte_len / (1 + BITS_PER_BYTE / 2 * BYTES_PER_BLOCK)
+   gc_pool_block_len       = gc_alloc_table_byte_len * BLOCKS_PER_ATB
+   gc_pool_start           = Heap_End - gc_pool_block_len * BYTES_PER_BLOCK
+
+ Every 16 byte block has 2 bits in the allocation table (4 blocks per ATB byte, block b
+ at bits 2*(b%4) of byte b/4):
+   00 FREE, 01 HEAD (first block of an object), 10 TAIL (rest of the object), 11 MARK
+ (a HEAD that the collector reached).
+
+ Differences to py/gc.c:
+  - alloc() looks for a run of free blocks 64 ATB bits (32 blocks) at a time: the 2-bit
+    states of a word are folded into a 32 bit "free" mask and a run of n free blocks is
+    found with shift-and, instead of testing one block after the other.
+  - instead of one last_free_atb_index there is one hint per run length (1..FREE_HINTS
+    blocks): no run of n free blocks starts below free_hint[n-1]. Small holes left at the
+    start of a fragmented pool are then skipped by larger allocations.
+  - the mark phase uses an explicit, fixed-size mark stack. When it overflows the
+    collector remembers that and rescans the marked objects afterwards, like gc.c does.
+  - roots are registered ranges of words, scanned conservatively (no stack scanning).
+************************************************************************************/
+
+#ifndef _GC_HEAP_H
+#define _GC_HEAP_H
+
+////////////////////  Includes ///////////////////
+#include <cstddef>                              //
+#include <cstdint>                              //
+#include <vector>                               //
+//////////////////////////////////////////////////
+
+class GcHeap{
+
+/* Public class methods  */
+public:
+   static const size_t BYTES_PER_BLOCK = 16;
+   static const size_t BITS_PER_BYTE = 8;
+   static const size_t BLOCKS_PER_ATB = 4;
+   static const size_t FREE_HINTS = 16;
+
+   enum BlockState : uint8_t { AT_FREE = 0, AT_HEAD = 1, AT_TAIL = 2, AT_MARK = 3 };
+
+   struct Info{
+      size_t total;        /* pool bytes */
+      size_t used;         /* bytes in allocated blocks */
+      size_t free;
+      size_t max_free;     /* longest run of free blocks, in blocks */
+      size_t num_objects;
+   };
+
+   /* lays out ATB and pool inside [heap_start, heap_end), the memory stays owned by the caller */
+   GcHeap(void* heap_start, void* heap_end, size_t mark_stack_size = 64);
+
+   /* returns nullptr when there is no run of free blocks large enough, even after a collection */
+   void* Alloc(size_t n_bytes, bool allow_collect = true);
+   void Free(void* ptr);
+   size_t NBytes(const void* ptr) const;
+
+   /* conservative roots: every word in [begin, begin + count) that points at an object keeps it alive */
+   void AddRoot(void* const* begin, size_t count);
+   void ClearRoots();
+   void Collect();
+
+   Info GetInfo() const;
+   size_t Collections() const { return collections; }
+
+   /* layout, named like the fields of mp_state_mem_area_t */
+   const uint8_t* gc_alloc_table_start() const { return atb; }
+   size_t gc_alloc_table_byte_len() const { return atb_len; }
+   const uint8_t* gc_pool_start() const { return pool_start; }
+   const uint8_t* gc_pool_end() const { return pool_end; }
+   size_t gc_pool_block_len() const { return pool_blocks; }
+
+/* Private attributes  */
+private:
+   uint8_t* atb;
+   size_t atb_len;
+   uint8_t* pool_start;
+   uint8_t* pool_end;
+   size_t pool_blocks;
+   size_t free_hint[FREE_HINTS];  /* no run of i+1 free blocks starts below free_hint[i] */
+   size_t collections;
+
+   struct Root{ void* const* begin; size_t count; };
+   std::vector<Root> roots;
+
+   std::vector<size_t> mark_stack;
+   size_t mark_sp;
+   bool mark_overflow;
+
+/* Private class methods  */
+private:
+   BlockState GetState(size_t block) const;
+   void SetState(size_t block, BlockState state);
+   void SetRange(size_t block, size_t n, BlockState state);
+   uint64_t LoadAtbWord(size_t word) const;
+   static uint32_t FreeMask(uint64_t atb_word);
+   size_t FindFreeRun(size_t n_blocks, size_t from) const;
+   void Freed(size_t block);
+   size_t BlockOf(const void* ptr) const;
+   bool VerifyPtr(const void* ptr) const;
+   size_t ObjectBlocks(size_t head) const;
+
+   void MarkPtr(const void* ptr);
+   void MarkDrain();
+   void ScanObject(size_t head);
+   void Sweep();
+};
+
+#endif  // _GC_HEAP_H